@@ -2,17 +2,45 @@
 
 #pragma once
 
+#include "bit.hpp"
+#include "type_traits.hpp"
+
 #include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <execution>
 #include <iterator>
+#include <limits>
+#include <numeric>
+#include <optional>
+#include <stdexcept>
+#include <thread>
 #include <tuple>
+#include <type_traits>
 #include <utility>
+#include <vector>
+
+#if defined(__SSE2__)
+    #include <immintrin.h>
+#endif // __SSE2__
 
 namespace extra {
 
+namespace detail {
+
+// the bitmap min_unused needs both the value and the elements to be integers
+template<class ForwardIt, class T>
+inline constexpr bool is_integral_min_unused_v =
+    std::is_integral_v<T> && std::is_integral_v<typename std::iterator_traits<ForwardIt>::value_type>;
+
+} // namespace detail
+
 // returns the minimum missing value from a range [first, last)
-// e.g. (min_unused(1, 4, 3) == 2);
+// e.g. over {1, 4, 3}, (min_unused(first, last, 1) == 2);
 // thanks to Bean Deane for this function implementation
-template<class ForwardIt, class T = typename ForwardIt::value_type>
+template<class ForwardIt, class T = typename ForwardIt::value_type, std::enable_if_t<!detail::is_integral_min_unused_v<ForwardIt, T>, int> = 0>
 constexpr T min_unused(ForwardIt first, ForwardIt last, T value = {}) {
     using diff_t = decltype(value - value);
     while (last != first) {
@@ -29,8 +57,89 @@ constexpr T min_unused(ForwardIt first, ForwardIt last, T value = {}) {
     return value;
 }
 
-template<class ExPo, class ForwardIt, class T = typename ForwardIt::value_type>
-constexpr T min_unused(ExPo&& exec, ForwardIt first, ForwardIt last, T value = {}) {
+namespace detail {
+
+// the index of the first 0 bit of words[0, n), n * 64 if every bit is set
+inline std::size_t first_zero_bit(std::uint64_t const* const words, std::size_t const n) noexcept {
+    std::size_t i = 0;
+#if defined(__AVX2__)
+    for (__m256i const ones = _mm256_set1_epi64x(-1); i + 4 <= n; i += 4)
+        if (!_mm256_testc_si256(_mm256_loadu_si256(reinterpret_cast<__m256i const*>(words + i)), ones))
+            break;
+#elif defined(__SSE2__)
+    for (__m128i const ones = _mm_set1_epi32(-1); i + 4 <= n; i += 4) {
+        __m128i const a = _mm_cmpeq_epi32(_mm_loadu_si128(reinterpret_cast<__m128i const*>(words + i)), ones);
+        __m128i const b = _mm_cmpeq_epi32(_mm_loadu_si128(reinterpret_cast<__m128i const*>(words + i + 2)), ones);
+        if (_mm_movemask_epi8(_mm_and_si128(a, b)) != 0xffff)
+            break;
+    }
+#endif // __AVX2__
+    for (; i < n; ++i)
+        if (words[i] != ~std::uint64_t{})
+            return i * 64 + static_cast<std::size_t>(countr_one(words[i]));
+    return n * 64;
+}
+
+// the offset of x from value, values below value wrap around to beyond any count
+template<class ForwardIt, class T>
+constexpr auto offset_from(T const value, typename std::iterator_traits<ForwardIt>::value_type const x) noexcept {
+    using value_t = typename std::iterator_traits<ForwardIt>::value_type;
+    using unsigned_t = std::make_unsigned_t<std::common_type_t<T, value_t>>;
+    return static_cast<unsigned_t>(static_cast<unsigned_t>(x) - static_cast<unsigned_t>(value));
+}
+
+template<class ForwardIt, class T>
+constexpr T nth_from(T const value, std::size_t const i) noexcept {
+    using value_t = typename std::iterator_traits<ForwardIt>::value_type;
+    using unsigned_t = std::make_unsigned_t<std::common_type_t<T, value_t>>;
+    return static_cast<T>(static_cast<unsigned_t>(value) + static_cast<unsigned_t>(i));
+}
+
+// sets bit i of bits for every element at offset i in [0, n] from value
+template<class ForwardIt, class T>
+void mark_present(ForwardIt first, ForwardIt const last, T const value, std::size_t const n, std::uint64_t* const bits) {
+    for (; first != last; ++first)
+        if (auto const i = offset_from<ForwardIt>(value, *first); i <= n)
+            bits[i / 64] |= std::uint64_t{1} << (i % 64);
+}
+
+template<class ForwardIt, class T>
+std::size_t min_unused_offset(ForwardIt const first, ForwardIt const last, T const value) {
+    auto const n = static_cast<std::size_t>(std::distance(first, last));
+    std::vector<std::uint64_t> bits(n / 64 + 1);
+    mark_present(first, last, value, n, bits.data());
+    return first_zero_bit(bits.data(), bits.size());
+}
+
+// the constant evaluation path, each offset in turn is searched for
+// in the range, quadratic but without the bitmap's allocation
+template<class ForwardIt, class T>
+constexpr std::size_t min_unused_offset_search(ForwardIt const first, ForwardIt const last, T const value) {
+    for (std::size_t i = 0;; ++i) {
+        auto it = first;
+        while (it != last && offset_from<ForwardIt>(value, *it) != i)
+            ++it;
+        if (it == last)
+            return i;
+    }
+}
+
+} // namespace detail
+
+// min_unused for integral values, does not reorder the range
+// n values leave one of [value, value + n] unused, so presence is marked in
+// a bitmap of n + 1 bits in a single read pass, values outside that span are
+// skipped however sparse they are, then the first zero bit is the answer
+// unlike the generic version duplicates and values below value are allowed
+template<class ForwardIt, class T = typename std::iterator_traits<ForwardIt>::value_type, std::enable_if_t<detail::is_integral_min_unused_v<ForwardIt, T>, int> = 0>
+constexpr T min_unused(ForwardIt const first, ForwardIt const last, T const value = {}) {
+    if (detail::is_constant_evaluated())
+        return detail::nth_from<ForwardIt>(value, detail::min_unused_offset_search(first, last, value));
+    return detail::nth_from<ForwardIt>(value, detail::min_unused_offset(first, last, value));
+}
+
+template<class ExPo, class ForwardIt, class T = typename ForwardIt::value_type, std::enable_if_t<!detail::is_integral_min_unused_v<ForwardIt, T>, int> = 0>
+T min_unused(ExPo&& exec, ForwardIt first, ForwardIt last, T value = {}) {
     using diff_t = decltype(value - value);
     while (last != first) {
         auto const half = (std::distance(first, last) + 1) / 2;
@@ -46,6 +155,265 @@ constexpr T min_unused(ExPo&& exec, ForwardIt first, ForwardIt last, T value = {
     return value;
 }
 
+namespace detail {
+
+// the fewest elements worth handing to another thread
+inline constexpr std::size_t parallel_min_unused_chunk_size = std::size_t{1} << 16;
+
+// words of the bitmap searched per task
+inline constexpr std::size_t parallel_min_unused_block_size = std::size_t{1} << 12;
+
+// policies that run on the calling thread only
+template<class ExPo>
+inline constexpr bool is_sequenced_policy_v = std::is_same_v<remove_cvref_t<ExPo>, std::execution::sequenced_policy>
+#if defined(__cpp_lib_execution) && __cpp_lib_execution >= 201902L
+    || std::is_same_v<remove_cvref_t<ExPo>, std::execution::unsequenced_policy>
+#endif // __cpp_lib_execution
+    ;
+
+} // namespace detail
+
+// min_unused for integral values on many threads in one pass over the range
+// every chunk marks its values in one shared bitmap of n + 1 bits, a bit is
+// only set with a relaxed fetch_or when a load finds it clear, then blocks
+// of words are searched concurrently and the first gap wins
+// scratch memory is n / 8 bytes however many threads take part, the atomic
+// marking costs more than the serial pass, so sequenced policies and a
+// single hardware thread take the serial path
+template<class ExPo, class ForwardIt, class T = typename std::iterator_traits<ForwardIt>::value_type, std::enable_if_t<detail::is_integral_min_unused_v<ForwardIt, T>, int> = 0>
+T min_unused(ExPo&& policy, ForwardIt const first, ForwardIt const last, T const value = {}) {
+    auto const n = static_cast<std::size_t>(std::distance(first, last));
+    std::size_t const threads = std::max(std::thread::hardware_concurrency(), 1u);
+    std::size_t const chunks = std::clamp<std::size_t>(n / detail::parallel_min_unused_chunk_size, 1, 4 * threads);
+    if (detail::is_sequenced_policy_v<ExPo> || chunks == 1 || threads == 1)
+        return min_unused(first, last, value);
+
+    std::vector<std::pair<ForwardIt, ForwardIt>> ranges{};
+    ranges.reserve(chunks);
+    auto it = first;
+    for (std::size_t i = 0; i < chunks; ++i) {
+        auto const end = i + 1 == chunks ? last : std::next(it, static_cast<std::ptrdiff_t>(n / chunks));
+        ranges.emplace_back(it, end);
+        it = end;
+    }
+
+    std::size_t const words = n / 64 + 1;
+    std::vector<std::atomic<std::uint64_t>> bits(words);
+    std::for_each(policy, ranges.begin(), ranges.end(), [&](auto const& range) {
+        for (auto x = range.first; x != range.second; ++x) {
+            if (auto const i = detail::offset_from<ForwardIt>(value, *x); i <= n) {
+                auto& word = bits[i / 64];
+                auto const bit = std::uint64_t{1} << (i % 64);
+                if ((word.load(std::memory_order_relaxed) & bit) == 0)
+                    word.fetch_or(bit, std::memory_order_relaxed);
+            }
+        }
+    });
+
+    std::vector<std::size_t> blocks{};
+    for (std::size_t w = 0; w < words; w += detail::parallel_min_unused_block_size)
+        blocks.push_back(w);
+    auto const i = std::transform_reduce(policy, blocks.begin(), blocks.end(), words * 64,
+        [](std::size_t const a, std::size_t const b) { return std::min(a, b); },
+        [&](std::size_t const begin) {
+            auto const end = std::min(begin + detail::parallel_min_unused_block_size, words);
+            for (std::size_t w = begin; w < end; ++w)
+                if (auto const word = bits[w].load(std::memory_order_relaxed); word != ~std::uint64_t{})
+                    return w * 64 + static_cast<std::size_t>(countr_one(word));
+            return words * 64;
+        });
+    return detail::nth_from<ForwardIt>(value, i);
+}
+
+// id_allocator - hands out the minimum unused value of [0, capacity)
+// a persistent replacement for calling min_unused on every change,
+// each level of the bitset has one bit per word of the level below
+// that is set when the word is full, so both acquire and release touch
+// one word per level, O(log64 n), rather than rescanning every id
+// with Concurrent the words are atomic and both are lock-free, acquire
+// claims a leaf bit with fetch_or and the summaries only guide the search,
+// the result is then the minimum unused value unless a release races it,
+// a summary that reads full is confirmed against the leaves before acquire
+// gives up, so full is only reported when a pass over them found no free id
+// throws std::length_error if capacity - 1 does not fit in T
+template<class T = std::size_t, bool Concurrent = false>
+class id_allocator {
+public:
+    explicit id_allocator(std::size_t const capacity)
+        : capacity_{capacity}
+    {
+        if (capacity > 0 && capacity - 1 > static_cast<std::uintmax_t>(std::numeric_limits<T>::max()))
+            throw std::length_error{"id_allocator: capacity exceeds the range of T"};
+        // every level has the words to cover the one below and ends at a single word,
+        // the bits past the end are set so they are never handed out
+        std::size_t bits = capacity;
+        do {
+            auto const words = bits == 0 ? 1 : (bits + 63) / 64;
+            levels_.emplace_back(words);
+            if (bits % 64 != 0 || bits == 0)
+                store(levels_.back().back(), all_set << (bits % 64));
+            bits = words;
+        } while (bits > 1);
+    }
+
+    id_allocator(id_allocator const&) = delete;
+    id_allocator& operator=(id_allocator const&) = delete;
+
+    // the minimum unused value marked as used, nullopt if every value is in use
+    [[nodiscard]] std::optional<T> acquire() {
+        auto const top = levels_.size() - 1;
+        for (;;) {
+            std::size_t index = 0;
+            std::size_t level = top;
+            for (; level > 0; --level) {
+                auto const word = load(levels_[level][index]);
+                if (word == all_set)
+                    break;
+                index = index * 64 + static_cast<std::size_t>(countr_one(word));
+            }
+            if (level == top && load(levels_[top][0]) == all_set) {
+                if constexpr (Concurrent) {
+                    // a mark_full racing a release briefly leaves the summaries
+                    // all set with a free leaf, only the leaves tell for sure
+                    for (std::size_t leaf = 0; leaf < levels_[0].size(); ++leaf)
+                        if (load(levels_[0][leaf]) != all_set)
+                            if (auto const id = claim(leaf))
+                                return id;
+                }
+                return std::nullopt;
+            }
+            if (level > 0) {
+                // a stale summary sent the search into a full word
+                mark_full(level, index);
+                continue;
+            }
+            if (auto const id = claim(index))
+                return id;
+        }
+    }
+
+    // marks value as unused again, returns false if it was not in use
+    bool release(T const value) {
+        auto const index = static_cast<std::size_t>(value);
+        if (index >= capacity_)
+            return false;
+        auto const bit = std::uint64_t{1} << (index % 64);
+        auto const prev = fetch_and(levels_[0][index / 64], ~bit);
+        if ((prev & bit) == 0)
+            return false;
+        add(size_, std::size_t(-1));
+        if (prev == all_set)
+            clear_full(0, index / 64);
+        return true;
+    }
+
+    [[nodiscard]] bool in_use(T const value) const noexcept {
+        auto const index = static_cast<std::size_t>(value);
+        return index < capacity_ && (load(levels_[0][index / 64]) >> (index % 64) & 1) != 0;
+    }
+
+    [[nodiscard]] std::size_t size() const noexcept { return load(size_); }
+    [[nodiscard]] std::size_t capacity() const noexcept { return capacity_; }
+    [[nodiscard]] bool empty() const noexcept { return size() == 0; }
+    [[nodiscard]] bool full() const noexcept { return load(levels_.back()[0]) == all_set; }
+
+private:
+    using word_t = std::conditional_t<Concurrent, std::atomic<std::uint64_t>, std::uint64_t>;
+    using size_t_ = std::conditional_t<Concurrent, std::atomic<std::size_t>, std::size_t>;
+
+    static constexpr std::uint64_t all_set = ~std::uint64_t{};
+
+    // takes the lowest free bit of leaf word index, nullopt once it is full
+    std::optional<T> claim(std::size_t const index) {
+        auto& leaf = levels_[0][index];
+        for (auto word = load(leaf); word != all_set;) {
+            auto const i = static_cast<std::size_t>(countr_one(word));
+            auto const bit = std::uint64_t{1} << i;
+            auto const prev = fetch_or(leaf, bit);
+            if ((prev & bit) == 0) {
+                if ((prev | bit) == all_set)
+                    mark_full(0, index);
+                add(size_, 1);
+                return static_cast<T>(index * 64 + i);
+            }
+            word = prev | bit;
+        }
+        mark_full(0, index);
+        return std::nullopt;
+    }
+
+    // sets the summary bits of a full word upwards while the parents fill up,
+    // a concurrent release may have freed a bit meanwhile, so the word is checked
+    // again once its summary bit is set and the bit is taken back if it is not full
+    void mark_full(std::size_t level, std::size_t index) {
+        for (; level + 1 < levels_.size(); ++level, index /= 64) {
+            auto const bit = std::uint64_t{1} << (index % 64);
+            auto const prev = fetch_or(levels_[level + 1][index / 64], bit);
+            if constexpr (Concurrent) {
+                if (load(levels_[level][index]) != all_set) {
+                    clear_full(level, index);
+                    return;
+                }
+            }
+            if ((prev | bit) != all_set)
+                return;
+        }
+    }
+
+    // clears the summary bits of a word that has room again upwards
+    // for as long as the parents were full before
+    void clear_full(std::size_t level, std::size_t index) {
+        for (; level + 1 < levels_.size(); ++level, index /= 64) {
+            auto const bit = std::uint64_t{1} << (index % 64);
+            if (fetch_and(levels_[level + 1][index / 64], ~bit) != all_set)
+                return;
+        }
+    }
+
+    template<class W>
+    static auto load(W const& w) noexcept {
+        if constexpr (Concurrent)
+            return w.load(std::memory_order_acquire);
+        else
+            return w;
+    }
+
+    static void store(word_t& w, std::uint64_t const value) noexcept {
+        if constexpr (Concurrent)
+            w.store(value, std::memory_order_relaxed);
+        else
+            w = value;
+    }
+
+    static std::uint64_t fetch_or(word_t& w, std::uint64_t const bits) noexcept {
+        if constexpr (Concurrent)
+            return w.fetch_or(bits, std::memory_order_acq_rel);
+        else
+            return std::exchange(w, w | bits);
+    }
+
+    static std::uint64_t fetch_and(word_t& w, std::uint64_t const bits) noexcept {
+        if constexpr (Concurrent)
+            return w.fetch_and(bits, std::memory_order_acq_rel);
+        else
+            return std::exchange(w, w & bits);
+    }
+
+    static void add(size_t_& n, std::size_t const delta) noexcept {
+        if constexpr (Concurrent)
+            n.fetch_add(delta, std::memory_order_relaxed);
+        else
+            n += delta;
+    }
+
+    std::size_t capacity_;
+    size_t_ size_{};
+    std::vector<std::vector<word_t>> levels_;
+};
+
+template<class T = std::size_t>
+using concurrent_id_allocator = id_allocator<T, true>;
+
 // apply a binary op to each adjacent pair in a range O(n)
 template<class FwIter, class BinOp>
 constexpr void _adjacent_pair_impl(FwIter first, FwIter const last, BinOp bin_op, std::forward_iterator_tag) {
@@ -73,13 +441,234 @@ constexpr void adjacent_pair(It const first, It const last, BinOp bin_op) {
         typename std::iterator_traits<It>::iterator_category{});
 }
 
+namespace detail {
+
+// the fewest adjacent pairs worth handing to another thread
+inline constexpr std::size_t parallel_adjacent_chunk_size = std::size_t{1} << 16;
+
+// splits the pairs of n elements into chunks of [begin, end) pair indices,
+// chunk i visits the elements [begin, end], overlapping the next one by one
+inline std::vector<std::pair<std::size_t, std::size_t>> make_pair_chunks(std::size_t const n) {
+    auto const pairs = n > 1 ? n - 1 : 0;
+    std::size_t const threads = std::max(std::thread::hardware_concurrency(), 1u);
+    std::size_t const chunks = std::clamp<std::size_t>(pairs / parallel_adjacent_chunk_size, 1, 4 * threads);
+    std::vector<std::pair<std::size_t, std::size_t>> ret{};
+    ret.reserve(chunks);
+    for (std::size_t i = 0; i < chunks && pairs != 0; ++i)
+        ret.emplace_back(pairs * i / chunks, pairs * (i + 1) / chunks);
+    return ret;
+}
+
+} // namespace detail
+
+// adjacent_pair on many threads for random access ranges, every pair is visited
+// exactly once but in no particular order, so bin_op must be safe to call concurrently
+template<class ExPo, class RandIter, class BinOp>
+void adjacent_pair(ExPo&& policy, RandIter const first, RandIter const last, BinOp bin_op) {
+    static_assert(std::is_base_of_v<std::random_access_iterator_tag, typename std::iterator_traits<RandIter>::iterator_category>,
+        "adjacent_pair with a policy needs random access iterators");
+    auto const chunks = detail::make_pair_chunks(static_cast<std::size_t>(last - first));
+    if (chunks.size() <= 1)
+        return adjacent_pair(first, last, bin_op);
+    std::for_each(policy, chunks.begin(), chunks.end(), [&](auto const& chunk) {
+        auto const begin = first + static_cast<std::ptrdiff_t>(chunk.first);
+        auto const end = first + static_cast<std::ptrdiff_t>(chunk.second + 1);
+        adjacent_pair(begin, end, [&](auto&& a, auto&& b) { bin_op(a, b); });
+    });
+}
+
+// combine(init, pair_op(a, b)) folded over every adjacent pair on many threads
+// each chunk folds its pairs in order and the chunks are combined in order,
+// so combine has to be associative but need not be commutative
+// e.g. adjacent_pair_reduce(par, v.begin(), v.end(), 0, [](int a, int b) { return a < b; }, std::plus<>{});
+template<class ExPo, class RandIter, class T, class PairOp, class Combine>
+T adjacent_pair_reduce(ExPo&& policy, RandIter const first, RandIter const last, T init, PairOp pair_op, Combine combine) {
+    static_assert(std::is_base_of_v<std::random_access_iterator_tag, typename std::iterator_traits<RandIter>::iterator_category>,
+        "adjacent_pair_reduce needs random access iterators");
+    struct chunk {
+        std::size_t begin;
+        std::size_t end;
+        std::optional<T> partial;
+    };
+    std::vector<chunk> chunks{};
+    for (auto const& [begin, end] : detail::make_pair_chunks(static_cast<std::size_t>(last - first)))
+        chunks.push_back({begin, end, std::nullopt});
+
+    std::for_each(policy, chunks.begin(), chunks.end(), [&](chunk& c) {
+        auto it = first + static_cast<std::ptrdiff_t>(c.begin);
+        auto const end = first + static_cast<std::ptrdiff_t>(c.end);
+        T acc = pair_op(it[0], it[1]);
+        for (++it; it != end; ++it)
+            acc = combine(std::move(acc), pair_op(it[0], it[1]));
+        c.partial = std::move(acc);
+    });
+    for (auto& c : chunks)
+        init = combine(std::move(init), std::move(*c.partial));
+    return init;
+}
+
+namespace detail {
+
+// pairs handed to a batch op at once, 64 bytes fill two AVX2 registers
+template<class T>
+inline constexpr std::size_t adjacent_batch_size = std::max<std::size_t>(64 / sizeof(T), 1);
+
+// the built in adjacent kernels use GCC vector extensions, one SSE2 or AVX2 register wide
+#if defined(__AVX2__)
+inline constexpr std::size_t simd_bytes = 32;
+#else
+inline constexpr std::size_t simd_bytes = 16;
+#endif // __AVX2__
+
+template<class T>
+inline constexpr bool is_simd_element_v = std::is_arithmetic_v<T> && !std::is_same_v<T, bool> && sizeof(T) <= 8;
+
+// 64-bit integer ordering is emulated before SSE4.2, slower than scalar code
+template<class T>
+inline constexpr bool is_simd_ordered_v = is_simd_element_v<T>
+#if !defined(__SSE4_2__)
+    && !(std::is_integral_v<T> && sizeof(T) == 8)
+#endif // __SSE4_2__
+    ;
+
+#if defined(__GNUC__)
+template<class T>
+struct simd {
+    typedef T type __attribute__((vector_size(simd_bytes)));
+    // comparisons give a lane of all ones for true as a signed integer of T's width
+    using mask = decltype(std::declval<type>() < std::declval<type>());
+    static constexpr std::size_t size = simd_bytes / sizeof(T);
+
+    static type load(T const* const p) noexcept {
+        type v;
+        std::memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
+    static bool any(mask const m) noexcept {
+        std::uint64_t words[sizeof(mask) / 8];
+        std::memcpy(words, &m, sizeof(m));
+        std::uint64_t bits{};
+        for (auto const w : words)
+            bits |= w;
+        return bits != 0;
+    }
+};
+#endif // __GNUC__
+
+} // namespace detail
+
+// adjacent_pair for contiguous ranges, batch_op(a, b, n) is called with
+// a[j], b[j] == first[i + j], first[i + j + 1] for j < n, n is the constant batch
+// size but for the last call so a loop over the lanes vectorizes, a batch op
+// that returns bool ends the walk early by returning false
+template<class T, class BatchOp, std::enable_if_t<std::is_trivially_copyable_v<T>, int> = 0>
+void adjacent_batches(T const* const first, T const* const last, BatchOp batch_op) {
+    constexpr auto batch = detail::adjacent_batch_size<T>;
+    auto const call = [&](std::size_t const i, std::size_t const n) {
+        if constexpr (std::is_same_v<std::invoke_result_t<BatchOp&, T const*, T const*, std::size_t>, bool>)
+            return batch_op(first + i, first + i + 1, n);
+        else {
+            batch_op(first + i, first + i + 1, n);
+            return true;
+        }
+    };
+    auto const pairs = last - first > 1 ? static_cast<std::size_t>(last - first - 1) : 0;
+    std::size_t i = 0;
+    for (; i + batch <= pairs; i += batch)
+        if (!call(i, batch))
+            return;
+    if (i < pairs)
+        call(i, pairs - i);
+}
+
+// adapts a scalar pair op to adjacent_batches, once inlined the lane loop vectorizes
+// e.g. adjacent_batches(first, last, pairwise([&](double a, double b) { sum += b - a; }));
+template<class BinOp>
+constexpr auto pairwise(BinOp bin_op) {
+    return [bin_op](auto const* const a, auto const* const b, std::size_t const n) mutable {
+        for (std::size_t j = 0; j < n; ++j)
+            bin_op(a[j], b[j]);
+    };
+}
+
+// writes first[i + 1] - first[i] for each adjacent pair to out, returns the end of out
+// out may be first, overwriting the input with its differences
+template<class T, std::enable_if_t<std::is_arithmetic_v<T>, int> = 0>
+T* adjacent_difference(T const* const first, T const* const last, T* const out) {
+    auto const pairs = last - first > 1 ? static_cast<std::size_t>(last - first - 1) : 0;
+    std::size_t i = 0;
+#if defined(__GNUC__)
+    if constexpr (detail::is_simd_element_v<T>) {
+        using simd = detail::simd<T>;
+        for (; i + simd::size <= pairs; i += simd::size) {
+            typename simd::type const d = simd::load(first + i + 1) - simd::load(first + i);
+            std::memcpy(out + i, &d, sizeof(d));
+        }
+    }
+#endif // __GNUC__
+    for (; i < pairs; ++i)
+        out[i] = static_cast<T>(first[i + 1] - first[i]);
+    return out + pairs;
+}
+
+// std::is_sorted for contiguous arithmetic ranges, a few registers at a time
+template<class T, std::enable_if_t<std::is_arithmetic_v<T>, int> = 0>
+bool is_sorted(T const* const first, T const* const last) {
+    auto const pairs = last - first > 1 ? static_cast<std::size_t>(last - first - 1) : 0;
+    std::size_t i = 0;
+#if defined(__GNUC__)
+    if constexpr (detail::is_simd_ordered_v<T>) {
+        using simd = detail::simd<T>;
+        for (; i + 4 * simd::size <= pairs; i += 4 * simd::size) {
+            typename simd::mask descents{};
+            for (std::size_t k = i; k < i + 4 * simd::size; k += simd::size)
+                descents |= simd::load(first + k + 1) < simd::load(first + k);
+            if (simd::any(descents))
+                return false;
+        }
+    }
+#endif // __GNUC__
+    for (; i < pairs; ++i)
+        if (first[i + 1] < first[i])
+            return false;
+    return true;
+}
+
+// the number of runs of equal adjacent values, e.g. {1, 1, 2, 1} has 3
+template<class T, std::enable_if_t<std::is_arithmetic_v<T>, int> = 0>
+std::size_t count_runs(T const* const first, T const* const last) {
+    if (first == last)
+        return 0;
+    auto const pairs = static_cast<std::size_t>(last - first - 1);
+    std::size_t changes{};
+    std::size_t i = 0;
+#if defined(__GNUC__)
+    if constexpr (detail::is_simd_element_v<T>) {
+        // each lane counts down by one per change, summed before a narrow lane can wrap
+        using simd = detail::simd<T>;
+        constexpr auto steps = (std::uint64_t{1} << (sizeof(T) * 8 - 1)) - 1;
+        while (i + simd::size <= pairs) {
+            typename simd::mask lanes{};
+            for (std::uint64_t k = 0; k < steps && i + simd::size <= pairs; ++k, i += simd::size)
+                lanes += simd::load(first + i) != simd::load(first + i + 1);
+            for (std::size_t j = 0; j < simd::size; ++j)
+                changes -= static_cast<std::size_t>(lanes[j]);
+        }
+    }
+#endif // __GNUC__
+    for (; i < pairs; ++i)
+        changes += first[i] != first[i + 1];
+    return changes + 1;
+}
+
 // apply a binary op to every pair in a range O(n^2)
 template<class FwIter, class BinOp>
 constexpr void _for_every_pair_impl(FwIter first, FwIter const last, BinOp bin_op, std::forward_iterator_tag) {
     if (first != last) {
         FwIter trailer = first;
         ++first;
-        for (; first != last, ++first, ++trailer)
+        for (; first != last; ++first, ++trailer)
             for (FwIter it = first; it != last; ++it)
                 bin_op(*trailer, *it);
     }
@@ -90,7 +679,7 @@ constexpr void _for_every_pair_impl(FwIter first, FwIter const last, BinOp bin_o
     if (first != last) {
         auto trailer = *first;
         ++first;
-        for (; first != last, ++first, ++trailer) {
+        for (; first != last; ++first) {
             for (FwIter it = first; it != last; ++it)
                 bin_op(trailer, *it);
             trailer = *first;
@@ -3,6 +3,7 @@
 #pragma once
 
 #include <cstring>
+#include <limits>
 #include <type_traits>
 
 namespace extra {
@@ -20,4 +21,32 @@ template<class To, class From,
     return dst;
 }
 
-}
\ No newline at end of file
+// c++20 implementation of std::countr_zero
+// the number of consecutive 0 bits, starting from the least significant bit
+template<class T, class = std::enable_if_t<std::is_unsigned_v<T>>>
+constexpr int countr_zero(T const x) noexcept {
+    if (x == 0)
+        return std::numeric_limits<T>::digits;
+#if defined(__GNUC__)
+    if constexpr (sizeof(T) <= sizeof(unsigned))
+        return __builtin_ctz(x);
+    else if constexpr (sizeof(T) <= sizeof(unsigned long))
+        return __builtin_ctzl(x);
+    else
+        return __builtin_ctzll(x);
+#else
+    int n = 0;
+    while (((x >> n) & 1) == 0)
+        ++n;
+    return n;
+#endif
+}
+
+// c++20 implementation of std::countr_one
+// the number of consecutive 1 bits, starting from the least significant bit
+template<class T, class = std::enable_if_t<std::is_unsigned_v<T>>>
+constexpr int countr_one(T const x) noexcept {
+    return countr_zero(static_cast<T>(~x));
+}
+
+}
@@ -0,0 +1,168 @@
+// io.hpp
+
+#pragma once
+
+#include "string.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstddef>
+#include <filesystem>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace extra {
+
+// mapped_file - a read-only memory mapping of a whole file (POSIX)
+// the contents are exposed as a string_view without copying them,
+// construction throws std::system_error if the file cannot be mapped
+class mapped_file {
+public:
+    mapped_file() noexcept = default;
+
+    explicit mapped_file(std::filesystem::path const& path) {
+        int const fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd == -1)
+            throw std::system_error{errno, std::generic_category(), path.string()};
+
+        struct ::stat st{};
+        if (::fstat(fd, &st) == -1) {
+            int const err = errno;
+            ::close(fd);
+            throw std::system_error{err, std::generic_category(), path.string()};
+        }
+
+        // mmap rejects zero length mappings, an empty file is an empty view
+        size_ = static_cast<std::size_t>(st.st_size);
+        if (size_ != 0) {
+            void* const addr = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (addr == MAP_FAILED) {
+                int const err = errno;
+                ::close(fd);
+                throw std::system_error{err, std::generic_category(), path.string()};
+            }
+            ::madvise(addr, size_, MADV_SEQUENTIAL);
+            data_ = static_cast<char const*>(addr);
+        }
+        ::close(fd);
+    }
+
+    mapped_file(mapped_file const&) = delete;
+    mapped_file& operator=(mapped_file const&) = delete;
+
+    mapped_file(mapped_file&& other) noexcept
+        : data_{std::exchange(other.data_, nullptr)}
+        , size_{std::exchange(other.size_, 0)}
+    {}
+
+    mapped_file& operator=(mapped_file&& other) noexcept {
+        if (this != &other) {
+            unmap();
+            data_ = std::exchange(other.data_, nullptr);
+            size_ = std::exchange(other.size_, 0);
+        }
+        return *this;
+    }
+
+    ~mapped_file() { unmap(); }
+
+    [[nodiscard]] char const* data() const noexcept { return data_; }
+    [[nodiscard]] std::size_t size() const noexcept { return size_; }
+    [[nodiscard]] bool empty() const noexcept { return size_ == 0; }
+
+    [[nodiscard]] std::string_view view() const noexcept { return {data_, size_}; }
+    [[nodiscard]] operator std::string_view() const noexcept { return view(); }
+
+private:
+    void unmap() noexcept {
+        if (data_ != nullptr)
+            ::munmap(const_cast<char*>(data_), size_);
+        data_ = nullptr;
+        size_ = 0;
+    }
+
+    char const* data_{};
+    std::size_t size_{};
+};
+
+// file_tokens - a range over the tokens of a mapped file
+// owns the mapping, tokens are views straight into it and stay valid
+// for as long as the file_tokens object (moving it keeps them valid)
+template<class Set>
+class file_tokens {
+public:
+    explicit file_tokens(mapped_file file, Set const& tokens = {})
+        : file_{std::move(file)}
+        , view_{file_.view(), tokens}
+    {}
+
+    [[nodiscard]] auto begin() const noexcept { return view_.begin(); }
+    [[nodiscard]] auto end() const noexcept { return view_.end(); }
+
+    [[nodiscard]] std::size_t count() const noexcept { return view_.count(); }
+
+    [[nodiscard]] mapped_file const& file() const noexcept { return file_; }
+
+private:
+    mapped_file file_;
+    basic_strtok_view<Set> view_;
+};
+
+// e.g. for (auto line : tokenize_file("access.log", "\n")) { ... }
+inline file_tokens<delimiter_set> tokenize_file(std::filesystem::path const& path, delimiter_set const& tokens) {
+    return file_tokens<delimiter_set>{mapped_file{path}, tokens};
+}
+
+inline file_tokens<delimiter_set> tokenize_file(std::filesystem::path const& path, std::string_view const tokens) {
+    return tokenize_file(path, delimiter_set{tokens});
+}
+
+// writes every piece to fd with writev, batches of at most IOV_MAX pieces,
+// retries partial writes and EINTR and throws std::system_error on failure
+inline void write_all(int const fd, std::vector<std::string_view> const& pieces) {
+    constexpr std::size_t batch = IOV_MAX < 1024 ? IOV_MAX : 1024;
+    ::iovec iov[batch];
+    std::size_t next{};         // the first piece not yet in iov
+    std::size_t skip{};         // bytes of pieces[next] already written
+    while (next < pieces.size()) {
+        auto const n = std::min(batch, pieces.size() - next);
+        for (std::size_t i = 0; i < n; ++i) {
+            auto const piece = pieces[next + i];
+            iov[i].iov_base = const_cast<char*>(piece.data());
+            iov[i].iov_len = piece.size();
+        }
+        iov[0].iov_base = static_cast<char*>(iov[0].iov_base) + skip;
+        iov[0].iov_len -= skip;
+
+        auto const written = ::writev(fd, iov, static_cast<int>(n));
+        if (written == -1) {
+            if (errno == EINTR)
+                continue;
+            throw std::system_error{errno, std::generic_category(), "writev"};
+        }
+        // advance past the fully written pieces, a partially written one is resumed
+        auto left = static_cast<std::size_t>(written);
+        for (std::size_t i = 0; i < n && left >= iov[i].iov_len; ++i) {
+            left -= iov[i].iov_len;
+            ++next;
+            skip = 0;
+        }
+        skip += left;
+    }
+}
+
+// e.g. builder.append(line).append('\n'); write_all(STDOUT_FILENO, builder);
+inline void write_all(int const fd, string_builder const& builder) {
+    write_all(fd, builder.pieces());
+}
+
+} // namespace extra
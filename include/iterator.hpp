@@ -348,7 +348,7 @@ private:
 public:
     constexpr explicit _zip_impl(Rs&&... ranges)
     noexcept(noexcept(iter_t{std::make_tuple(std::begin(std::forward<Rs>(ranges))...)}) 
-    && noexcept(iter_t{std::make_tuple(std::end(std::forward<Rs>(ranges))...)}))
+    && noexcept(sentinel_t{std::make_tuple(std::end(std::forward<Rs>(ranges))...)}))
         : begin_{std::make_tuple(std::begin(std::forward<Rs>(ranges))...)}
         , end_{std::make_tuple(std::end(std::forward<Rs>(ranges))...)} 
     {}
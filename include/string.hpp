@@ -2,63 +2,3166 @@
 
 #pragma once
 
+#include "type_traits.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
 #include <string_view>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    #define EXTRA_STRING_X86_SIMD
+    #include <immintrin.h>
+#endif // __GNUC__ && x86
+
 namespace extra {
 
+namespace detail {
+
+constexpr int countr_zero(std::uint64_t x) noexcept {
+#if defined(__GNUC__)
+    return __builtin_ctzll(x);
+#else
+    int n = 0;
+    for (; !(x & 1); x >>= 1)
+        ++n;
+    return n;
+#endif
+}
+
+constexpr int countl_zero(std::uint64_t x) noexcept {
+#if defined(__GNUC__)
+    return __builtin_clzll(x);
+#else
+    int n = 0;
+    for (; !(x >> 63); x <<= 1)
+        ++n;
+    return n;
+#endif
+}
+
+} // namespace detail
+
+// delimiter_set - a 256-bit byte classification table
+// byte c is a member iff bit (c >> 4) & 7 of table[c >> 7][c & 0xf] is set,
+// this is the layout the nibble lookup (pshufb) kernels consume directly
+class delimiter_set {
+public:
+    constexpr delimiter_set() noexcept = default;
+
+    constexpr delimiter_set(std::string_view const delims) noexcept {
+        for (char const c : delims)
+            insert(c);
+    }
+
+    constexpr void insert(char const c) noexcept {
+        auto const u = static_cast<unsigned char>(c);
+        table_[u >> 7][u & 0xf] |= static_cast<std::uint8_t>(1u << ((u >> 4) & 7));
+    }
+
+    [[nodiscard]] constexpr bool contains(char const c) const noexcept {
+        auto const u = static_cast<unsigned char>(c);
+        return (table_[u >> 7][u & 0xf] >> ((u >> 4) & 7)) & 1;
+    }
+
+    // bit i is set iff p[i] is a member, for the 64 bytes starting at p
+    [[nodiscard]] std::uint64_t mask64(char const* p) const noexcept;
+
+    // bit i is set iff p[i] is a member, for i < n <= 64
+    [[nodiscard]] constexpr std::uint64_t mask(char const* p, std::size_t const n) const noexcept {
+        if (n == 64 && !detail::is_constant_evaluated())
+            return mask64(p);
+        std::uint64_t m{};
+        for (std::size_t i = 0; i < n; ++i)
+            m |= static_cast<std::uint64_t>(contains(p[i])) << i;
+        return m;
+    }
+
+    [[nodiscard]] constexpr std::size_t find_first_of(std::string_view const str, std::size_t const pos = 0) const noexcept {
+        return find(str, pos, 0);
+    }
+
+    [[nodiscard]] constexpr std::size_t find_first_not_of(std::string_view const str, std::size_t const pos = 0) const noexcept {
+        return find(str, pos, ~std::uint64_t{});
+    }
+
+    [[nodiscard]] constexpr std::size_t find_last_of(std::string_view const str, std::size_t const pos = std::string_view::npos) const noexcept {
+        return rfind(str, pos, 0);
+    }
+
+    [[nodiscard]] constexpr std::size_t find_last_not_of(std::string_view const str, std::size_t const pos = std::string_view::npos) const noexcept {
+        return rfind(str, pos, ~std::uint64_t{});
+    }
+
+    // the 16 byte nibble table for bytes < 0x80 (half == 0) or >= 0x80 (half == 1)
+    [[nodiscard]] constexpr std::uint8_t const* table(std::size_t const half) const noexcept { return table_[half]; }
+
+private:
+    // flip inverts the member mask to search for non-members
+    constexpr std::size_t find(std::string_view const str, std::size_t pos, std::uint64_t const flip) const noexcept {
+        for (; pos < str.size(); pos += 64) {
+            auto const n = str.size() - pos < 64 ? str.size() - pos : 64;
+            auto const valid = n == 64 ? ~std::uint64_t{} : (std::uint64_t{1} << n) - 1;
+            if (auto const m = (mask(str.data() + pos, n) ^ flip) & valid; m != 0)
+                return pos + static_cast<std::size_t>(detail::countr_zero(m));
+        }
+        return std::string_view::npos;
+    }
+
+    // searches the blocks ending at pos from the back
+    constexpr std::size_t rfind(std::string_view const str, std::size_t const pos, std::uint64_t const flip) const noexcept {
+        if (str.empty())
+            return std::string_view::npos;
+        for (auto end = (pos < str.size() ? pos : str.size() - 1) + 1; end != 0;) {
+            auto const begin = end < 64 ? 0 : end - 64;
+            auto const n = end - begin;
+            auto const valid = n == 64 ? ~std::uint64_t{} : (std::uint64_t{1} << n) - 1;
+            if (auto const m = (mask(str.data() + begin, n) ^ flip) & valid; m != 0)
+                return begin + static_cast<std::size_t>(63 - detail::countl_zero(m));
+            end = begin;
+        }
+        return std::string_view::npos;
+    }
+
+    std::uint8_t table_[2][16]{};
+};
+
+namespace detail {
+
+inline std::uint64_t delimiter_mask64_scalar(delimiter_set const& set, char const* p) noexcept {
+    std::uint64_t m{};
+    for (std::size_t i = 0; i < 64; ++i)
+        m |= static_cast<std::uint64_t>(set.contains(p[i])) << i;
+    return m;
+}
+
+#ifdef EXTRA_STRING_X86_SIMD
+
+__attribute__((target("sse4.2")))
+inline std::uint64_t delimiter_mask64_sse42(delimiter_set const& set, char const* p) noexcept {
+    __m128i const lo_tbl = _mm_loadu_si128(reinterpret_cast<__m128i const*>(set.table(0)));
+    __m128i const hi_tbl = _mm_loadu_si128(reinterpret_cast<__m128i const*>(set.table(1)));
+    __m128i const bits = _mm_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+    __m128i const nibble = _mm_set1_epi8(0x0f);
+
+    std::uint64_t m{};
+    for (int i = 0; i < 4; ++i) {
+        __m128i const v = _mm_loadu_si128(reinterpret_cast<__m128i const*>(p + 16 * i));
+        __m128i const lo = _mm_and_si128(v, nibble);
+        __m128i const hi = _mm_and_si128(_mm_srli_epi16(v, 4), nibble);
+        __m128i const row = _mm_blendv_epi8(_mm_shuffle_epi8(lo_tbl, lo), _mm_shuffle_epi8(hi_tbl, lo), v);
+        __m128i const bit = _mm_shuffle_epi8(bits, hi);
+        __m128i const hit = _mm_cmpeq_epi8(_mm_and_si128(row, bit), bit);
+        m |= static_cast<std::uint64_t>(static_cast<std::uint16_t>(_mm_movemask_epi8(hit))) << (16 * i);
+    }
+    return m;
+}
+
+__attribute__((target("avx2")))
+inline std::uint64_t delimiter_mask64_avx2(delimiter_set const& set, char const* p) noexcept {
+    __m256i const lo_tbl = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<__m128i const*>(set.table(0))));
+    __m256i const hi_tbl = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<__m128i const*>(set.table(1))));
+    __m256i const bits = _mm256_setr_epi8(
+        1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128,
+        1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+    __m256i const nibble = _mm256_set1_epi8(0x0f);
+
+    std::uint64_t m{};
+    for (int i = 0; i < 2; ++i) {
+        __m256i const v = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(p + 32 * i));
+        __m256i const lo = _mm256_and_si256(v, nibble);
+        __m256i const hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), nibble);
+        __m256i const row = _mm256_blendv_epi8(_mm256_shuffle_epi8(lo_tbl, lo), _mm256_shuffle_epi8(hi_tbl, lo), v);
+        __m256i const bit = _mm256_shuffle_epi8(bits, hi);
+        __m256i const hit = _mm256_cmpeq_epi8(_mm256_and_si256(row, bit), bit);
+        m |= static_cast<std::uint64_t>(static_cast<std::uint32_t>(_mm256_movemask_epi8(hit))) << (32 * i);
+    }
+    return m;
+}
+
+#endif // EXTRA_STRING_X86_SIMD
+
+using delimiter_mask64_fn = std::uint64_t (*)(delimiter_set const&, char const*) noexcept;
+
+// picks the widest kernel the running cpu supports, evaluated once
+inline delimiter_mask64_fn select_delimiter_mask64() noexcept {
+#ifdef EXTRA_STRING_X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return &delimiter_mask64_avx2;
+    if (__builtin_cpu_supports("sse4.2"))
+        return &delimiter_mask64_sse42;
+#endif // EXTRA_STRING_X86_SIMD
+    return &delimiter_mask64_scalar;
+}
+
+constexpr int popcount(std::uint64_t x) noexcept {
+#if defined(__GNUC__)
+    return __builtin_popcountll(x);
+#else
+    int n = 0;
+    for (; x != 0; x &= x - 1)
+        ++n;
+    return n;
+#endif
+}
+
+// token_scanner - walks a string one 64 byte block at a time, yielding
+// every maximal run of non-delimiters, each byte is classified once
+template<class Set>
+class token_scanner {
+public:
+    constexpr token_scanner() noexcept = default;
+
+    constexpr token_scanner(std::string_view const str, Set const& delims) noexcept
+        : str_{str}
+        , delims_{delims}
+    {}
+
+    // stores the next token in [begin, end), returns false once str is exhausted
+    constexpr bool next(std::size_t& begin, std::size_t& end) noexcept {
+        for (;;) {
+            while (changes_ != 0) {
+                auto const i = pos_ + static_cast<std::size_t>(countr_zero(changes_));
+                changes_ &= changes_ - 1;
+                if ((tok_ >> (i - pos_)) & 1)
+                    begin_ = i;
+                else {
+                    begin = begin_;
+                    end = i;
+                    return true;
+                }
+            }
+            if (next_ >= str_.size()) {
+                if (!carry_)
+                    return false;
+                carry_ = 0;
+                begin = begin_;
+                end = str_.size();
+                return true;
+            }
+            load();
+        }
+    }
+
+    [[nodiscard]] constexpr std::string_view str() const noexcept { return str_; }
+    [[nodiscard]] constexpr Set const& delims() const noexcept { return delims_; }
+
+private:
+    constexpr void load() noexcept {
+        pos_ = next_;
+        auto const n = str_.size() - pos_ < 64 ? str_.size() - pos_ : 64;
+        auto const valid = n == 64 ? ~std::uint64_t{} : (std::uint64_t{1} << n) - 1;
+        tok_ = ~delims_.mask(str_.data() + pos_, n) & valid;
+        // bits where the byte class differs from the previous byte
+        changes_ = (tok_ ^ ((tok_ << 1) | carry_)) & valid;
+        carry_ = (tok_ >> (n - 1)) & 1;
+        next_ = pos_ + n;
+    }
+
+    std::string_view str_{};
+    Set delims_{};
+    std::size_t pos_{};
+    std::size_t next_{};
+    std::size_t begin_{};
+    std::uint64_t tok_{};       // 1 for each non-delimiter in the current block
+    std::uint64_t changes_{};   // transitions not yet reported
+    std::uint64_t carry_{};     // 1 if the last loaded byte was part of a token
+};
+
+// calls fn(begin, end) for every maximal run of non-delimiters in str
+template<class Set, class Fn>
+constexpr void for_each_token(std::string_view const str, Set const& delims, Fn&& fn) {
+    token_scanner<Set> scanner{str, delims};
+    for (std::size_t begin{}, end{}; scanner.next(begin, end);)
+        fn(begin, end);
+}
+
+// counts the maximal runs of non-delimiters in str
+template<class Set>
+constexpr std::size_t count_tokens(std::string_view const str, Set const& delims) noexcept {
+    std::size_t count{};
+    std::uint64_t carry{};
+    for (std::size_t pos = 0; pos < str.size(); pos += 64) {
+        auto const n = str.size() - pos < 64 ? str.size() - pos : 64;
+        auto const valid = n == 64 ? ~std::uint64_t{} : (std::uint64_t{1} << n) - 1;
+        auto const tok = ~delims.mask(str.data() + pos, n) & valid;
+        // a token starts where a non-delimiter follows a delimiter
+        count += static_cast<std::size_t>(popcount(tok & ~((tok << 1) | carry)));
+        carry = (tok >> (n - 1)) & 1;
+    }
+    return count;
+}
+
+// removes the next token from the front of str and returns it
+template<class Set>
+constexpr std::string_view next_token(std::string_view& str, Set const& delims) noexcept {
+    auto const begin = delims.find_first_not_of(str);
+    auto const end = delims.find_first_of(str, begin);
+
+    if (end != std::string_view::npos) {
+        std::string_view const ret{str.data() + begin, end - begin};
+        str.remove_prefix(end);
+        return ret;
+    }
+    else if (begin != std::string_view::npos) {
+        std::string_view const ret{str.data() + begin, str.size() - begin};
+        str.remove_prefix(str.size());
+        return ret;
+    }
+    else
+        return {};
+}
+
+// removes the last token from the back of str and returns it
+template<class Set>
+constexpr std::string_view prev_token(std::string_view& str, Set const& delims) noexcept {
+    auto const last = delims.find_last_not_of(str);
+    if (last == std::string_view::npos) {
+        str = {};
+        return {};
+    }
+    auto const delim = delims.find_last_of(str, last);
+    auto const begin = delim == std::string_view::npos ? 0 : delim + 1;
+    std::string_view const ret{str.data() + begin, last + 1 - begin};
+    str = str.substr(0, begin);
+    return ret;
+}
+
+} // namespace detail
+
+inline std::uint64_t delimiter_set::mask64(char const* p) const noexcept {
+    static detail::delimiter_mask64_fn const kernel = detail::select_delimiter_mask64();
+    return kernel(*this, p);
+}
+
+namespace detail {
+
+// bit i is set iff p[i] == c, for the 64 bytes starting at p
+inline std::uint64_t byte_mask64(char const c, char const* p) noexcept {
+#if defined(EXTRA_STRING_X86_SIMD) && defined(__SSE2__)
+    __m128i const needle = _mm_set1_epi8(c);
+    std::uint64_t m{};
+    for (int i = 0; i < 4; ++i) {
+        __m128i const v = _mm_loadu_si128(reinterpret_cast<__m128i const*>(p + 16 * i));
+        m |= static_cast<std::uint64_t>(static_cast<std::uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, needle)))) << (16 * i);
+    }
+    return m;
+#else
+    std::uint64_t m{};
+    for (std::size_t i = 0; i < 64; ++i)
+        m |= static_cast<std::uint64_t>(p[i] == c) << i;
+    return m;
+#endif
+}
+
+// bit i is set iff p[i] == c, for i < n <= 64
+constexpr std::uint64_t byte_mask(char const c, char const* p, std::size_t const n) noexcept {
+    if (n == 64 && !is_constant_evaluated())
+        return byte_mask64(c, p);
+    std::uint64_t m{};
+    for (std::size_t i = 0; i < n; ++i)
+        m |= static_cast<std::uint64_t>(p[i] == c) << i;
+    return m;
+}
+
+} // namespace detail
+
+// static_delimiter_set - a delimiter set fixed at compile time
+// the classification table is built during constant evaluation,
+// e.g. static_delimiter_set<' ', '\t'>
+template<char... Delims>
+class static_delimiter_set {
+    static_assert(sizeof...(Delims) > 0, "extra::static_delimiter_set requires at least one delimiter");
+
+    static constexpr char chars_[] = {Delims...};
+    static constexpr delimiter_set set_{std::string_view{chars_, sizeof...(Delims)}};
+
+public:
+    [[nodiscard]] static constexpr bool contains(char const c) noexcept { return set_.contains(c); }
+
+    [[nodiscard]] static constexpr std::uint64_t mask(char const* p, std::size_t const n) noexcept {
+        return set_.mask(p, n);
+    }
+
+    [[nodiscard]] static constexpr std::size_t find_first_of(std::string_view const str, std::size_t const pos = 0) noexcept {
+        return set_.find_first_of(str, pos);
+    }
+
+    [[nodiscard]] static constexpr std::size_t find_first_not_of(std::string_view const str, std::size_t const pos = 0) noexcept {
+        return set_.find_first_not_of(str, pos);
+    }
+};
+
+// a single delimiter collapses to a byte compare, find_first_of is memchr
+template<char Delim>
+class static_delimiter_set<Delim> {
+public:
+    [[nodiscard]] static constexpr bool contains(char const c) noexcept { return c == Delim; }
+
+    [[nodiscard]] static constexpr std::uint64_t mask(char const* p, std::size_t const n) noexcept {
+        return detail::byte_mask(Delim, p, n);
+    }
+
+    [[nodiscard]] static constexpr std::size_t find_first_of(std::string_view const str, std::size_t const pos = 0) noexcept {
+        return str.find(Delim, pos);
+    }
+
+    [[nodiscard]] static constexpr std::size_t find_first_not_of(std::string_view const str, std::size_t pos = 0) noexcept {
+        for (; pos < str.size(); pos += 64) {
+            auto const n = str.size() - pos < 64 ? str.size() - pos : 64;
+            auto const valid = n == 64 ? ~std::uint64_t{} : (std::uint64_t{1} << n) - 1;
+            if (auto const m = ~mask(str.data() + pos, n) & valid; m != 0)
+                return pos + static_cast<std::size_t>(detail::countr_zero(m));
+        }
+        return std::string_view::npos;
+    }
+};
+
+#if defined(__cpp_nontype_template_args) && __cpp_nontype_template_args >= 201911L
+
+// fixed_string - a string literal usable as a template argument (C++20)
+template<std::size_t N>
+struct fixed_string {
+    char data[N]{};
+
+    constexpr fixed_string(char const (&str)[N]) noexcept {
+        for (std::size_t i = 0; i < N; ++i)
+            data[i] = str[i];
+    }
+};
+
+namespace detail {
+
+template<fixed_string Str, std::size_t... Is>
+auto make_static_delimiter_set(std::index_sequence<Is...>) -> static_delimiter_set<Str.data[Is]...>;
+
+} // namespace detail
+
+// e.g. static_delimiters_of<" \t,">
+template<fixed_string Str>
+using static_delimiters_of = decltype(detail::make_static_delimiter_set<Str>(std::make_index_sequence<sizeof(Str.data) - 1>{}));
+
+#endif // __cpp_nontype_template_args
+
 class strtok {
 public:
     template<class... Args>
-    constexpr explicit strtok(Args&&... args) noexcept 
+    constexpr explicit strtok(Args&&... args) noexcept
         : str_{std::forward<Args>(args)...}
     {}
 
     [[nodiscard]] constexpr std::string_view operator()(std::string_view const tokens) noexcept {
-        return tokenize(tokens);
+        return tokenize(delimiter_set{tokens});
     }
 
     [[nodiscard]] constexpr std::string_view operator()(std::string_view const& str, std::string_view const tokens) noexcept {
+        str_ = str;
+        return tokenize(delimiter_set{tokens});
+    }
+
+    [[nodiscard]] constexpr std::string_view operator()(delimiter_set const& tokens) noexcept {
+        return tokenize(tokens);
+    }
+
+    [[nodiscard]] constexpr std::string_view operator()(std::string_view const& str, delimiter_set const& tokens) noexcept {
         str_ = str;
         return tokenize(tokens);
     }
 
 private:
-    constexpr std::string_view tokenize(std::string_view const& tokens) noexcept {
-        auto const begin = str_.find_first_not_of(tokens);
-        auto const end = str_.find_first_of(tokens, begin);
+    constexpr std::string_view tokenize(delimiter_set const& tokens) noexcept {
+        return detail::next_token(str_, tokens);
+    }
+
+    std::string_view str_;
+};
+
+// rstrtok - strtok scanning from the end of the string
+// yields tokens back to front, so trailing fields cost O(suffix)
+// e.g. rstrtok tok{"GET /index.html 200 13ms"}; tok(" ") == "13ms"
+class rstrtok {
+public:
+    template<class... Args>
+    constexpr explicit rstrtok(Args&&... args) noexcept
+        : str_{std::forward<Args>(args)...}
+    {}
+
+    [[nodiscard]] constexpr std::string_view operator()(std::string_view const tokens) noexcept {
+        return detail::prev_token(str_, delimiter_set{tokens});
+    }
+
+    [[nodiscard]] constexpr std::string_view operator()(std::string_view const& str, std::string_view const tokens) noexcept {
+        str_ = str;
+        return detail::prev_token(str_, delimiter_set{tokens});
+    }
+
+    [[nodiscard]] constexpr std::string_view operator()(delimiter_set const& tokens) noexcept {
+        return detail::prev_token(str_, tokens);
+    }
+
+    [[nodiscard]] constexpr std::string_view operator()(std::string_view const& str, delimiter_set const& tokens) noexcept {
+        str_ = str;
+        return detail::prev_token(str_, tokens);
+    }
+
+private:
+    std::string_view str_;
+};
+
+// basic_strtok - strtok with its delimiters fixed by the type Set
+// e.g. strtok_ct<' ', '\t'> tok{str}; tok() == first token
+template<class Set>
+class basic_strtok {
+public:
+    constexpr explicit basic_strtok(std::string_view const str = {}, Set const& tokens = {}) noexcept
+        : str_{str}
+        , tokens_{tokens}
+    {}
+
+    [[nodiscard]] constexpr std::string_view operator()() noexcept {
+        return detail::next_token(str_, tokens_);
+    }
+
+    [[nodiscard]] constexpr std::string_view operator()(std::string_view const& str) noexcept {
+        str_ = str;
+        return detail::next_token(str_, tokens_);
+    }
+
+private:
+    std::string_view str_;
+    Set tokens_;
+};
+
+template<char... Delims>
+using strtok_ct = basic_strtok<static_delimiter_set<Delims...>>;
 
-        if (end != std::string_view::npos) {
-            std::string_view const ret{str_.begin() + begin, end - begin};
-            str_.remove_prefix(end);
-            return ret;
+// basic_strtok_view - a lazy range over the tokens of a string
+// tokens are produced on demand while iterating and nothing is allocated
+template<class Set>
+class basic_strtok_view {
+public:
+    class sentinel {};
+
+    class iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = std::string_view;
+        using difference_type = std::ptrdiff_t;
+        using pointer = std::string_view const*;
+        using reference = std::string_view const&;
+
+        constexpr iterator() noexcept = default;
+
+        constexpr explicit iterator(detail::token_scanner<Set> const& scanner) noexcept
+            : scanner_{scanner}
+        {
+            advance();
         }
-        else if (begin != std::string_view::npos) {
-            std::string_view const ret{str_.begin() + begin, str_.size() - begin};
-            str_.remove_prefix(str_.size());
-            return ret;
+
+        [[nodiscard]] constexpr reference operator*() const noexcept { return token_; }
+        [[nodiscard]] constexpr pointer operator->() const noexcept { return &token_; }
+
+        constexpr iterator& operator++() noexcept {
+            advance();
+            return *this;
         }
-        else
-            return {};
-    }
 
+        constexpr iterator operator++(int) noexcept {
+            auto saved{*this};
+            advance();
+            return saved;
+        }
+
+        friend constexpr bool operator==(iterator const& lhs, iterator const& rhs) noexcept {
+            return lhs.done_ == rhs.done_ && lhs.token_.data() == rhs.token_.data();
+        }
+
+        friend constexpr bool operator!=(iterator const& lhs, iterator const& rhs) noexcept {
+            return !(lhs == rhs);
+        }
+
+        friend constexpr bool operator==(iterator const& it, sentinel) noexcept { return it.done_; }
+        friend constexpr bool operator==(sentinel, iterator const& it) noexcept { return it.done_; }
+        friend constexpr bool operator!=(iterator const& it, sentinel) noexcept { return !it.done_; }
+        friend constexpr bool operator!=(sentinel, iterator const& it) noexcept { return !it.done_; }
+
+    private:
+        constexpr void advance() noexcept {
+            std::size_t begin{}, end{};
+            done_ = !scanner_.next(begin, end);
+            token_ = done_ ? std::string_view{} : scanner_.str().substr(begin, end - begin);
+        }
+
+        detail::token_scanner<Set> scanner_{};
+        std::string_view token_{};
+        bool done_{true};
+    };
+
+    constexpr basic_strtok_view(std::string_view const str, Set const& tokens = {}) noexcept
+        : str_{str}
+        , tokens_{tokens}
+    {}
+
+    template<class S = Set, std::enable_if_t<std::is_constructible_v<S, std::string_view>, int> = 0>
+    constexpr basic_strtok_view(std::string_view const str, std::string_view const tokens) noexcept
+        : str_{str}
+        , tokens_{tokens}
+    {}
+
+    [[nodiscard]] constexpr iterator begin() const noexcept { return iterator{detail::token_scanner<Set>{str_, tokens_}}; }
+    [[nodiscard]] constexpr sentinel end() const noexcept { return {}; }
+
+    [[nodiscard]] constexpr bool empty() const noexcept { return tokens_.find_first_not_of(str_) == std::string_view::npos; }
+
+    // an O(1) upper bound on the number of tokens
+    [[nodiscard]] constexpr std::size_t size_hint() const noexcept { return (str_.size() + 1) / 2; }
+
+    // the exact number of tokens, requires a pass over the string
+    [[nodiscard]] constexpr std::size_t count() const noexcept { return detail::count_tokens(str_, tokens_); }
+
+private:
     std::string_view str_;
+    Set tokens_;
 };
 
-std::vector<std::string_view> strtok_all(std::string_view const str, std::string_view const tokens) noexcept {
+using strtok_view = basic_strtok_view<delimiter_set>;
+
+inline std::vector<std::string_view> strtok_all(std::string_view const str, delimiter_set const& tokens) noexcept {
     std::vector<std::string_view> ret{};
-    
-    std::size_t begin{str.find_first_not_of(tokens)};
-    std::size_t end{str.find_first_of(tokens, begin)};
+    detail::for_each_token(str, tokens, [&](std::size_t const begin, std::size_t const end) {
+        ret.emplace_back(str.data() + begin, end - begin);
+    });
+    return ret;
+}
+
+inline std::vector<std::string_view> strtok_all(std::string_view const str, std::string_view const tokens) noexcept {
+    return strtok_all(str, delimiter_set{tokens});
+}
+
+// basic_stream_tokenizer - splits a stream that arrives in successive buffers
+// fn(token) is called as soon as a token is complete, tokens are views into
+// the buffer passed to feed, except a token spanning two buffers which is
+// assembled in an internal carry buffer, the only memory held between feeds
+// e.g. while (read(fd, buf)) tok.feed(buf, fn); tok.finish(fn);
+template<class Set>
+class basic_stream_tokenizer {
+public:
+    explicit basic_stream_tokenizer(Set const& tokens = {})
+        : tokens_{tokens}
+    {}
+
+    template<class S = Set, std::enable_if_t<std::is_constructible_v<S, std::string_view>, int> = 0>
+    explicit basic_stream_tokenizer(std::string_view const tokens)
+        : tokens_{tokens}
+    {}
+
+    // tokenizes the next buffer of the stream, a trailing
+    // token is held back until the next feed or finish
+    template<class Fn>
+    void feed(std::string_view const buffer, Fn&& fn) {
+        detail::token_scanner<Set> scanner{buffer, tokens_};
+        for (std::size_t begin{}, end{}; scanner.next(begin, end);) {
+            auto const token = buffer.substr(begin, end - begin);
+            if (!carry_.empty()) {
+                if (begin == 0) {
+                    carry_.append(token);
+                    if (end == buffer.size())
+                        return;
+                    fn(std::string_view{carry_});
+                    carry_.clear();
+                    continue;
+                }
+                fn(std::string_view{carry_});
+                carry_.clear();
+            }
+            if (end == buffer.size()) {
+                carry_.assign(token);
+                return;
+            }
+            fn(token);
+        }
+        // the buffer held only delimiters, so the pending token is complete
+        if (!carry_.empty() && !buffer.empty()) {
+            fn(std::string_view{carry_});
+            carry_.clear();
+        }
+    }
+
+    // flushes the token pending at the end of the stream
+    template<class Fn>
+    void finish(Fn&& fn) {
+        if (!carry_.empty()) {
+            fn(std::string_view{carry_});
+            carry_.clear();
+        }
+    }
+
+    // the bytes of a token spanning buffers seen so far
+    [[nodiscard]] std::string_view pending() const noexcept { return carry_; }
+
+private:
+    Set tokens_;
+    std::string carry_;
+};
+
+using stream_tokenizer = basic_stream_tokenizer<delimiter_set>;
+
+// counts the tokens strtok_all would return without producing any of them
+// token starts are popcounted from the vectorized delimiter masks
+[[nodiscard]] constexpr std::size_t strtok_count(std::string_view const str, delimiter_set const& tokens) noexcept {
+    return detail::count_tokens(str, tokens);
+}
+
+[[nodiscard]] constexpr std::size_t strtok_count(std::string_view const str, std::string_view const tokens) noexcept {
+    return detail::count_tokens(str, delimiter_set{tokens});
+}
+
+template<char... Delims>
+[[nodiscard]] constexpr std::size_t strtok_count(std::string_view const str) noexcept {
+    return detail::count_tokens(str, static_delimiter_set<Delims...>{});
+}
+
+namespace detail {
 
-    while (end != std::string_view::npos) { 
-        ret.emplace_back(str.begin() + begin, end - begin);
-        begin = str.find_first_not_of(tokens, end);
-        end = str.find_first_of(tokens, begin);
+// the smallest piece of input worth handing to another thread
+inline constexpr std::size_t parallel_token_chunk_size = std::size_t{1} << 20;
+
+struct token_chunk {
+    std::string_view str;
+    std::vector<std::string_view> tokens;
+    std::size_t offset;
+};
+
+// splits str into chunks whose boundaries sit on a delimiter,
+// so no token ever spans two chunks
+template<class Set>
+std::vector<token_chunk> make_token_chunks(std::string_view const str, Set const& delims) {
+    std::size_t const threads = std::max(std::thread::hardware_concurrency(), 1u);
+    std::size_t const chunks = std::clamp<std::size_t>(str.size() / parallel_token_chunk_size, 1, 4 * threads);
+    std::size_t const step = str.size() / chunks;
+
+    std::vector<token_chunk> ret{};
+    ret.reserve(chunks);
+    std::size_t begin{};
+    for (std::size_t i = 1; i <= chunks && begin < str.size(); ++i) {
+        auto end = i == chunks ? str.size() : delims.find_first_of(str, std::max(begin, i * step));
+        if (end == std::string_view::npos)
+            end = str.size();
+        ret.push_back({str.substr(begin, end - begin), {}, 0});
+        begin = end;
     }
-    if (begin != std::string_view::npos)
-        ret.emplace_back(str.begin() + begin, str.size() - begin);
     return ret;
 }
 
-} // namespace extra
+} // namespace detail
+
+// splits str concurrently, the result is identical to the serial strtok_all
+// every chunk is scanned once into its own vector, the vectors are then
+// spliced into the output at their prefix-summed offsets
+template<class ExPo>
+std::vector<std::string_view> strtok_all(ExPo&& policy, std::string_view const str, delimiter_set const& tokens) {
+    auto chunks = detail::make_token_chunks(str, tokens);
+    std::for_each(policy, chunks.begin(), chunks.end(), [&](detail::token_chunk& chunk) {
+        chunk.tokens = strtok_all(chunk.str, tokens);
+    });
+
+    std::size_t total{};
+    for (auto& chunk : chunks) {
+        chunk.offset = total;
+        total += chunk.tokens.size();
+    }
+
+    std::vector<std::string_view> ret(total);
+    std::for_each(policy, chunks.begin(), chunks.end(), [&](detail::token_chunk& chunk) {
+        std::copy(chunk.tokens.begin(), chunk.tokens.end(), ret.begin() + static_cast<std::ptrdiff_t>(chunk.offset));
+        chunk.tokens = {};
+    });
+    return ret;
+}
+
+template<class ExPo>
+std::vector<std::string_view> strtok_all(ExPo&& policy, std::string_view const str, std::string_view const tokens) {
+    return strtok_all(std::forward<ExPo>(policy), str, delimiter_set{tokens});
+}
+
+// e.g. strtok_all<' ', ','>("a, b") == {"a", "b"}
+template<char... Delims>
+std::vector<std::string_view> strtok_all(std::string_view const str) noexcept {
+    std::vector<std::string_view> ret{};
+    detail::for_each_token(str, static_delimiter_set<Delims...>{}, [&](std::size_t const begin, std::size_t const end) {
+        ret.emplace_back(str.data() + begin, end - begin);
+    });
+    return ret;
+}
+
+namespace detail {
+
+// the number of bytes of the utf-8 sequence led by c, 0 for a continuation or invalid byte
+constexpr std::size_t utf8_sequence_length(char const c) noexcept {
+    auto const u = static_cast<unsigned char>(c);
+    if (u < 0x80)
+        return 1;
+    if (u >= 0xc2 && u <= 0xdf)
+        return 2;
+    if ((u & 0xf0) == 0xe0)
+        return 3;
+    if (u >= 0xf0 && u <= 0xf4)
+        return 4;
+    return 0;
+}
+
+constexpr bool utf8_valid_scalar(char const* const p, std::size_t const n) noexcept {
+    for (std::size_t i = 0; i < n;) {
+        auto const len = utf8_sequence_length(p[i]);
+        if (len == 0 || len > n - i)
+            return false;
+        auto const lead = static_cast<unsigned char>(p[i]);
+        std::uint32_t cp = len == 1 ? lead : lead & (0x7f >> len);
+        for (std::size_t k = 1; k < len; ++k) {
+            auto const u = static_cast<unsigned char>(p[i + k]);
+            if ((u & 0xc0) != 0x80)
+                return false;
+            cp = (cp << 6) | (u & 0x3f);
+        }
+        // overlong 3 and 4 byte forms, surrogates and code points past U+10FFFF
+        if ((len == 3 && (cp < 0x800 || (cp >= 0xd800 && cp <= 0xdfff))) || (len == 4 && (cp < 0x10000 || cp > 0x10ffff)))
+            return false;
+        i += len;
+    }
+    return true;
+}
+
+#ifdef EXTRA_STRING_X86_SIMD
+
+struct utf8_state_sse42 {
+    __m128i prev;           // the previous block
+    __m128i incomplete;     // nonzero if prev ends in an unfinished sequence
+    __m128i error;
+};
+
+// keiser and lemire's lookup validator, every pair of adjacent bytes is
+// classified by three 16 entry tables whose bits name the errors the pair
+// could be part of, an error needs all three to agree, 3 and 4 byte
+// sequences are then checked by the continuation bytes they must have
+__attribute__((target("sse4.2")))
+inline void utf8_step_sse42(utf8_state_sse42& state, __m128i const in) noexcept {
+    constexpr char too_short = 1 << 0;
+    constexpr char too_long = 1 << 1;
+    constexpr char overlong_3 = 1 << 2;
+    constexpr char too_large = 1 << 3;
+    constexpr char surrogate = 1 << 4;
+    constexpr char overlong_2 = 1 << 5;
+    constexpr char too_large_1000 = 1 << 6;
+    constexpr char overlong_4 = 1 << 6;
+    constexpr char two_conts = static_cast<char>(1 << 7);
+    constexpr char carry = too_short | too_long | two_conts;
+    constexpr char large = carry | too_large | too_large_1000;
+
+    if (_mm_movemask_epi8(in) == 0) {
+        state.error = _mm_or_si128(state.error, state.incomplete);
+        state.incomplete = _mm_setzero_si128();
+        state.prev = in;
+        return;
+    }
+
+    // indexed by the high nibble of the first byte
+    __m128i const byte_1_high = _mm_setr_epi8(
+        too_long, too_long, too_long, too_long, too_long, too_long, too_long, too_long,
+        two_conts, two_conts, two_conts, two_conts,
+        too_short | overlong_2, too_short, too_short | overlong_3 | surrogate,
+        too_short | too_large | too_large_1000 | overlong_4);
+    // indexed by the low nibble of the first byte
+    __m128i const byte_1_low = _mm_setr_epi8(
+        carry | overlong_3 | overlong_2 | overlong_4, carry | overlong_2, carry, carry,
+        carry | too_large, large, large, large, large, large, large, large, large,
+        large | surrogate, large, large);
+    // indexed by the high nibble of the second byte
+    __m128i const byte_2_high = _mm_setr_epi8(
+        too_short, too_short, too_short, too_short, too_short, too_short, too_short, too_short,
+        too_long | overlong_2 | two_conts | overlong_3 | too_large_1000 | overlong_4,
+        too_long | overlong_2 | two_conts | overlong_3 | too_large,
+        too_long | overlong_2 | two_conts | surrogate | too_large,
+        too_long | overlong_2 | two_conts | surrogate | too_large,
+        too_short, too_short, too_short, too_short);
+    // a block ending in the lead byte of an unfinished sequence exceeds these
+    __m128i const max_tail = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+        static_cast<char>(0xef), static_cast<char>(0xdf), static_cast<char>(0xbf));
+    __m128i const nibble = _mm_set1_epi8(0x0f);
+
+    __m128i const prev1 = _mm_alignr_epi8(in, state.prev, 15);
+    __m128i const special = _mm_and_si128(_mm_and_si128(
+        _mm_shuffle_epi8(byte_1_high, _mm_and_si128(_mm_srli_epi16(prev1, 4), nibble)),
+        _mm_shuffle_epi8(byte_1_low, _mm_and_si128(prev1, nibble))),
+        _mm_shuffle_epi8(byte_2_high, _mm_and_si128(_mm_srli_epi16(in, 4), nibble)));
+    // bytes 2 and 3 back are 3 and 4 byte leads iff these have the high bit set
+    __m128i const third = _mm_subs_epu8(_mm_alignr_epi8(in, state.prev, 14), _mm_set1_epi8(0xe0 - 0x80));
+    __m128i const fourth = _mm_subs_epu8(_mm_alignr_epi8(in, state.prev, 13), _mm_set1_epi8(0xf0 - 0x80));
+    __m128i const must_continue = _mm_and_si128(_mm_or_si128(third, fourth), _mm_set1_epi8(static_cast<char>(0x80)));
+    state.error = _mm_or_si128(state.error, _mm_xor_si128(must_continue, special));
+    state.incomplete = _mm_subs_epu8(in, max_tail);
+    state.prev = in;
+}
+
+__attribute__((target("sse4.2")))
+inline bool utf8_valid_sse42(char const* const p, std::size_t const n) noexcept {
+    utf8_state_sse42 state{_mm_setzero_si128(), _mm_setzero_si128(), _mm_setzero_si128()};
+    std::size_t i = 0;
+    for (; i + 64 <= n; i += 64) {
+        __m128i const a = _mm_loadu_si128(reinterpret_cast<__m128i const*>(p + i));
+        __m128i const b = _mm_loadu_si128(reinterpret_cast<__m128i const*>(p + i + 16));
+        __m128i const c = _mm_loadu_si128(reinterpret_cast<__m128i const*>(p + i + 32));
+        __m128i const d = _mm_loadu_si128(reinterpret_cast<__m128i const*>(p + i + 48));
+        // 64 ascii bytes only need to end any sequence left unfinished before them
+        if (_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(a, b), _mm_or_si128(c, d))) == 0) {
+            state.error = _mm_or_si128(state.error, state.incomplete);
+            state.incomplete = _mm_setzero_si128();
+            state.prev = d;
+            continue;
+        }
+        utf8_step_sse42(state, a);
+        utf8_step_sse42(state, b);
+        utf8_step_sse42(state, c);
+        utf8_step_sse42(state, d);
+    }
+    for (; i + 16 <= n; i += 16)
+        utf8_step_sse42(state, _mm_loadu_si128(reinterpret_cast<__m128i const*>(p + i)));
+    // the tail padded with ascii, which also ends any unfinished sequence
+    char tail[16]{};
+    if (i != n)
+        std::memcpy(tail, p + i, n - i);
+    utf8_step_sse42(state, _mm_loadu_si128(reinterpret_cast<__m128i const*>(tail)));
+    return _mm_testz_si128(state.error, state.error) != 0;
+}
+
+#endif // EXTRA_STRING_X86_SIMD
+
+using utf8_valid_fn = bool (*)(char const*, std::size_t) noexcept;
+
+inline utf8_valid_fn select_utf8_valid() noexcept {
+#ifdef EXTRA_STRING_X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse4.2"))
+        return &utf8_valid_sse42;
+#endif // EXTRA_STRING_X86_SIMD
+    return &utf8_valid_scalar;
+}
+
+} // namespace detail
+
+// true if str is well-formed utf-8 (no overlong forms, surrogates or code points past U+10FFFF)
+[[nodiscard]] inline bool is_valid_utf8(std::string_view const str) noexcept {
+    static detail::utf8_valid_fn const kernel = detail::select_utf8_valid();
+    return kernel(str.data(), str.size());
+}
+
+// utf8_delimiter_set - delimiters given as utf-8 code points
+// a multi-byte delimiter only matches at the lead byte of its own sequence,
+// so it never matches part of another code point, ascii delimiters are
+// searched for with the same vectorized classification as delimiter_set
+// e.g. utf8_delimiter_set{" \u3001\u00a0"} splits on space, ideographic comma and nbsp
+class utf8_delimiter_set {
+public:
+    utf8_delimiter_set() = default;
+
+    // throws std::invalid_argument if delims is not valid utf-8
+    explicit utf8_delimiter_set(std::string_view const delims) {
+        if (!detail::utf8_valid_scalar(delims.data(), delims.size()))
+            throw std::invalid_argument{"utf8_delimiter_set: delimiters are not valid utf-8"};
+        for (std::size_t i = 0; i < delims.size();) {
+            auto const len = detail::utf8_sequence_length(delims[i]);
+            if (len == 1)
+                ascii_.insert(delims[i]);
+            else if (std::find(multi_.begin(), multi_.end(), delims.substr(i, len)) == multi_.end())
+                multi_.emplace_back(delims.substr(i, len));
+            starts_.insert(delims[i]);
+            i += len;
+        }
+    }
+
+    // the length of the delimiter starting at str[pos], 0 if there is none
+    [[nodiscard]] std::size_t match(std::string_view const str, std::size_t const pos) const noexcept {
+        if (ascii_.contains(str[pos]))
+            return 1;
+        if (!starts_.contains(str[pos]))
+            return 0;
+        for (auto const& delim : multi_)
+            if (str.compare(pos, delim.size(), delim) == 0)
+                return delim.size();
+        return 0;
+    }
+
+    // the position of the first delimiter at or after pos, npos if there is none
+    [[nodiscard]] std::size_t find_first_of(std::string_view const str, std::size_t pos = 0) const noexcept {
+        for (;; ++pos) {
+            pos = starts_.find_first_of(str, pos);
+            if (pos == std::string_view::npos || match(str, pos) != 0)
+                return pos;
+        }
+    }
+
+    // the single byte delimiters
+    [[nodiscard]] delimiter_set const& ascii() const noexcept { return ascii_; }
+
+private:
+    delimiter_set ascii_{};
+    delimiter_set starts_{};            // ascii_ and the lead bytes of multi_
+    std::vector<std::string> multi_{};
+};
+
+namespace detail {
+
+// how far validation runs ahead of the tokens, in bytes
+inline constexpr std::size_t utf8_validate_chunk = 4 * 1024;
+
+// utf8_token_scanner - splits utf-8 text on code point delimiters
+// the input is validated in chunks just ahead of the tokens returned, a chunk
+// ends on a code point boundary so each one can be validated on its own
+class utf8_token_scanner {
+public:
+    utf8_token_scanner() noexcept = default;
+
+    utf8_token_scanner(std::string_view const str, utf8_delimiter_set delims) noexcept
+        : str_{str}
+        , delims_{std::move(delims)}
+    {}
+
+    // stores the next token, returns false once str is exhausted, throws
+    // std::system_error (illegal_byte_sequence) if str is not valid utf-8
+    bool next(std::string_view& token) {
+        for (std::size_t n{}; pos_ < str_.size() && (n = delims_.match(str_, pos_)) != 0;)
+            pos_ += n;
+        if (pos_ == str_.size()) {
+            validate(str_.size());
+            return false;
+        }
+        auto const end = std::min(delims_.find_first_of(str_, pos_), str_.size());
+        validate(end);
+        token = str_.substr(pos_, end - pos_);
+        pos_ = end;
+        return true;
+    }
+
+private:
+    void validate(std::size_t const end) {
+        if (end <= checked_)
+            return;
+        auto target = std::min(str_.size(), std::max(end, checked_ + utf8_validate_chunk));
+        // back up to the start of a code point, but never before end
+        for (int i = 0; i < 3 && target > end && target < str_.size() && (static_cast<unsigned char>(str_[target]) & 0xc0) == 0x80; ++i)
+            --target;
+        if (!is_valid_utf8(str_.substr(checked_, target - checked_)))
+            throw std::system_error{std::make_error_code(std::errc::illegal_byte_sequence), "invalid utf-8"};
+        checked_ = target;
+    }
+
+    std::string_view str_{};
+    utf8_delimiter_set delims_{};
+    std::size_t pos_{};
+    std::size_t checked_{};     // [0, checked_) is known to be valid
+};
+
+} // namespace detail
+
+// utf8_strtok_view - a lazy range over the tokens of utf-8 text split on
+// code point delimiters, advancing throws std::system_error if the text
+// is not valid utf-8, the view and its iterators hold their own copy of
+// the delimiter set
+class utf8_strtok_view {
+public:
+    class sentinel {};
+
+    class iterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = std::string_view;
+        using difference_type = std::ptrdiff_t;
+        using pointer = std::string_view const*;
+        using reference = std::string_view const&;
+
+        iterator() noexcept = default;
+
+        explicit iterator(detail::utf8_token_scanner const& scanner)
+            : scanner_{scanner}
+        {
+            advance();
+        }
+
+        [[nodiscard]] reference operator*() const noexcept { return token_; }
+        [[nodiscard]] pointer operator->() const noexcept { return &token_; }
+
+        iterator& operator++() {
+            advance();
+            return *this;
+        }
+
+        iterator operator++(int) {
+            auto saved{*this};
+            advance();
+            return saved;
+        }
+
+        friend bool operator==(iterator const& lhs, iterator const& rhs) noexcept {
+            return lhs.done_ == rhs.done_ && lhs.token_.data() == rhs.token_.data();
+        }
+
+        friend bool operator!=(iterator const& lhs, iterator const& rhs) noexcept {
+            return !(lhs == rhs);
+        }
+
+        friend bool operator==(iterator const& it, sentinel) noexcept { return it.done_; }
+        friend bool operator==(sentinel, iterator const& it) noexcept { return it.done_; }
+        friend bool operator!=(iterator const& it, sentinel) noexcept { return !it.done_; }
+        friend bool operator!=(sentinel, iterator const& it) noexcept { return !it.done_; }
+
+    private:
+        void advance() {
+            done_ = !scanner_.next(token_);
+            if (done_)
+                token_ = {};
+        }
+
+        detail::utf8_token_scanner scanner_{};
+        std::string_view token_{};
+        bool done_{true};
+    };
+
+    utf8_strtok_view(std::string_view const str, utf8_delimiter_set delims) noexcept
+        : str_{str}
+        , delims_{std::move(delims)}
+    {}
+
+    [[nodiscard]] iterator begin() const { return iterator{detail::utf8_token_scanner{str_, delims_}}; }
+    [[nodiscard]] sentinel end() const noexcept { return {}; }
+
+private:
+    std::string_view str_;
+    utf8_delimiter_set delims_;
+};
+
+// throws std::system_error (illegal_byte_sequence) if str is not valid utf-8
+// e.g. utf8_strtok_all("a\u3001b c", " \u3001") == {"a", "b", "c"}
+inline std::vector<std::string_view> utf8_strtok_all(std::string_view const str, utf8_delimiter_set delims) {
+    std::vector<std::string_view> ret{};
+    detail::utf8_token_scanner scanner{str, std::move(delims)};
+    for (std::string_view token{}; scanner.next(token);)
+        ret.push_back(token);
+    return ret;
+}
+
+inline std::vector<std::string_view> utf8_strtok_all(std::string_view const str, std::string_view const delims) {
+    return utf8_strtok_all(str, utf8_delimiter_set{delims});
+}
+
+namespace detail {
+
+// substring_finder - finds a multi-byte needle in a haystack
+// candidates are filtered by comparing the first and last needle byte
+// against a whole vector of positions at once, only those are compared
+// fully, the scalar path and the tail of the haystack use horspool
+class substring_finder {
+public:
+    constexpr substring_finder() noexcept = default;
+
+    constexpr explicit substring_finder(std::string_view const needle) noexcept
+        : needle_{needle}
+    {
+        auto const m = needle_.size();
+        auto const max_skip = m < 255 ? m : 255;
+        for (auto& skip : skip_)
+            skip = static_cast<std::uint8_t>(max_skip);
+        for (std::size_t i = 0; i + 1 < m; ++i) {
+            auto const dist = m - 1 - i;
+            skip_[static_cast<unsigned char>(needle_[i])] = static_cast<std::uint8_t>(dist < 255 ? dist : 255);
+        }
+    }
+
+    [[nodiscard]] constexpr std::string_view needle() const noexcept { return needle_; }
+
+    // the position of the first needle at or after pos, npos if there is none
+    [[nodiscard]] constexpr std::size_t find(std::string_view const haystack, std::size_t const pos = 0) const noexcept {
+        auto const m = needle_.size();
+        if (m == 0 || pos > haystack.size() || haystack.size() - pos < m)
+            return std::string_view::npos;
+        if (m == 1)
+            return haystack.find(needle_[0], pos);
+        if (!is_constant_evaluated())
+            return find_vectorized(haystack, pos);
+        return horspool(haystack, pos);
+    }
+
+    [[nodiscard]] constexpr std::size_t horspool(std::string_view const haystack, std::size_t pos) const noexcept {
+        auto const m = needle_.size();
+        while (pos + m <= haystack.size()) {
+            auto const last = haystack[pos + m - 1];
+            if (last == needle_[m - 1] && std::char_traits<char>::compare(haystack.data() + pos, needle_.data(), m - 1) == 0)
+                return pos;
+            pos += skip_[static_cast<unsigned char>(last)];
+        }
+        return std::string_view::npos;
+    }
+
+private:
+    std::size_t find_vectorized(std::string_view haystack, std::size_t pos) const noexcept;
+
+    std::string_view needle_{};
+    std::uint8_t skip_[256]{};
+};
+
+#ifdef EXTRA_STRING_X86_SIMD
+
+__attribute__((target("sse2")))
+inline std::size_t substring_find_sse2(substring_finder const& finder, std::string_view const haystack, std::size_t pos) noexcept {
+    auto const needle = finder.needle();
+    auto const m = needle.size();
+    __m128i const first = _mm_set1_epi8(needle[0]);
+    __m128i const last = _mm_set1_epi8(needle[m - 1]);
+    for (; pos + m - 1 + 16 <= haystack.size(); pos += 16) {
+        __m128i const a = _mm_loadu_si128(reinterpret_cast<__m128i const*>(haystack.data() + pos));
+        __m128i const b = _mm_loadu_si128(reinterpret_cast<__m128i const*>(haystack.data() + pos + m - 1));
+        auto mask = static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(a, first), _mm_cmpeq_epi8(b, last))));
+        for (; mask != 0; mask &= mask - 1) {
+            auto const i = pos + static_cast<std::size_t>(countr_zero(mask));
+            if (std::char_traits<char>::compare(haystack.data() + i + 1, needle.data() + 1, m - 2) == 0)
+                return i;
+        }
+    }
+    return finder.horspool(haystack, pos);
+}
+
+__attribute__((target("avx2")))
+inline std::size_t substring_find_avx2(substring_finder const& finder, std::string_view const haystack, std::size_t pos) noexcept {
+    auto const needle = finder.needle();
+    auto const m = needle.size();
+    __m256i const first = _mm256_set1_epi8(needle[0]);
+    __m256i const last = _mm256_set1_epi8(needle[m - 1]);
+    for (; pos + m - 1 + 32 <= haystack.size(); pos += 32) {
+        __m256i const a = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(haystack.data() + pos));
+        __m256i const b = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(haystack.data() + pos + m - 1));
+        auto mask = static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(a, first), _mm256_cmpeq_epi8(b, last))));
+        for (; mask != 0; mask &= mask - 1) {
+            auto const i = pos + static_cast<std::size_t>(countr_zero(mask));
+            if (std::char_traits<char>::compare(haystack.data() + i + 1, needle.data() + 1, m - 2) == 0)
+                return i;
+        }
+    }
+    return finder.horspool(haystack, pos);
+}
+
+#endif // EXTRA_STRING_X86_SIMD
+
+inline std::size_t substring_find_scalar(substring_finder const& finder, std::string_view const haystack, std::size_t const pos) noexcept {
+    return finder.horspool(haystack, pos);
+}
+
+using substring_find_fn = std::size_t (*)(substring_finder const&, std::string_view, std::size_t) noexcept;
+
+inline substring_find_fn select_substring_find() noexcept {
+#ifdef EXTRA_STRING_X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return &substring_find_avx2;
+    if (__builtin_cpu_supports("sse2"))
+        return &substring_find_sse2;
+#endif // EXTRA_STRING_X86_SIMD
+    return &substring_find_scalar;
+}
+
+inline std::size_t substring_finder::find_vectorized(std::string_view const haystack, std::size_t const pos) const noexcept {
+    static substring_find_fn const kernel = select_substring_find();
+    return kernel(*this, haystack, pos);
+}
+
+} // namespace detail
+
+// split_view - a lazy range over the pieces of a string between
+// occurrences of a multi-byte delimiter, like strtok empty pieces are skipped
+// iterators copy the finder, so they stay valid after a temporary view is gone
+class split_view {
+public:
+    class sentinel {};
+
+    class iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = std::string_view;
+        using difference_type = std::ptrdiff_t;
+        using pointer = std::string_view const*;
+        using reference = std::string_view const&;
+
+        constexpr iterator() noexcept = default;
+
+        constexpr iterator(std::string_view const str, detail::substring_finder const& finder) noexcept
+            : str_{str}
+            , finder_{finder}
+        {
+            advance();
+        }
+
+        [[nodiscard]] constexpr reference operator*() const noexcept { return token_; }
+        [[nodiscard]] constexpr pointer operator->() const noexcept { return &token_; }
+
+        constexpr iterator& operator++() noexcept {
+            advance();
+            return *this;
+        }
+
+        constexpr iterator operator++(int) noexcept {
+            auto saved{*this};
+            advance();
+            return saved;
+        }
+
+        friend constexpr bool operator==(iterator const& lhs, iterator const& rhs) noexcept {
+            return lhs.done_ == rhs.done_ && lhs.token_.data() == rhs.token_.data();
+        }
+
+        friend constexpr bool operator!=(iterator const& lhs, iterator const& rhs) noexcept {
+            return !(lhs == rhs);
+        }
+
+        friend constexpr bool operator==(iterator const& it, sentinel) noexcept { return it.done_; }
+        friend constexpr bool operator==(sentinel, iterator const& it) noexcept { return it.done_; }
+        friend constexpr bool operator!=(iterator const& it, sentinel) noexcept { return !it.done_; }
+        friend constexpr bool operator!=(sentinel, iterator const& it) noexcept { return !it.done_; }
+
+    private:
+        constexpr void advance() noexcept {
+            auto const str = str_;
+            auto const m = finder_.needle().size();
+            while (pos_ < str.size()) {
+                auto const found = finder_.find(str, pos_);
+                if (found == pos_) {
+                    pos_ += m;
+                    continue;
+                }
+                auto const end = found == std::string_view::npos ? str.size() : found;
+                token_ = str.substr(pos_, end - pos_);
+                pos_ = end == str.size() ? end : end + m;
+                done_ = false;
+                return;
+            }
+            token_ = {};
+            done_ = true;
+        }
+
+        std::string_view str_{};
+        detail::substring_finder finder_{};
+        std::size_t pos_{};
+        std::string_view token_{};
+        bool done_{true};
+    };
+
+    constexpr split_view(std::string_view const str, std::string_view const delim) noexcept
+        : str_{str}
+        , finder_{delim}
+    {}
+
+    [[nodiscard]] constexpr iterator begin() const noexcept { return iterator{str_, finder_}; }
+    [[nodiscard]] constexpr sentinel end() const noexcept { return {}; }
+
+private:
+    std::string_view str_;
+    detail::substring_finder finder_;
+};
+
+// e.g. split_on("a\r\nb\r\n", "\r\n") yields "a", "b"
+[[nodiscard]] constexpr split_view split_on(std::string_view const str, std::string_view const delim) noexcept {
+    return split_view{str, delim};
+}
+
+// a line of text without its newline, number counts from 1 and
+// offset is the position of the line's first byte in the input
+struct text_line {
+    std::string_view text{};
+    std::size_t number{};
+    std::size_t offset{};
+};
+
+enum class line_options : unsigned {
+    none = 0,
+    keep_cr = 1 << 0,       // leave the \r of a \r\n line ending in the line
+    skip_empty = 1 << 1,    // do not yield empty lines, like strtok(str)("\n")
+};
+
+[[nodiscard]] constexpr line_options operator|(line_options const lhs, line_options const rhs) noexcept {
+    return static_cast<line_options>(static_cast<unsigned>(lhs) | static_cast<unsigned>(rhs));
+}
+
+[[nodiscard]] constexpr bool operator&(line_options const lhs, line_options const rhs) noexcept {
+    return (static_cast<unsigned>(lhs) & static_cast<unsigned>(rhs)) != 0;
+}
+
+namespace detail {
+
+// line_scanner - splits text on '\n', newlines are found 64 bytes at a time
+// and kept as a bit mask, so short lines cost a bit scan each and long
+// ones a vector compare per 16 bytes
+class line_scanner {
+public:
+    constexpr line_scanner() noexcept = default;
+
+    constexpr line_scanner(std::string_view const str, line_options const options) noexcept
+        : str_{str}
+        , options_{options}
+    {
+        load();
+    }
+
+    // stores the next line, returns false once str is exhausted,
+    // a final newline does not start another (empty) line
+    constexpr bool next(text_line& out) noexcept {
+        while (pos_ < str_.size()) {
+            auto const end = next_newline();
+            auto text = str_.substr(pos_, end - pos_);
+            if (!(options_ & line_options::keep_cr) && !text.empty() && text.back() == '\r')
+                text.remove_suffix(1);
+            out = {text, ++number_, pos_};
+            pos_ = end == str_.size() ? end : end + 1;
+            if (!text.empty() || !(options_ & line_options::skip_empty))
+                return true;
+        }
+        return false;
+    }
+
+private:
+    constexpr void load() noexcept {
+        auto const n = str_.size() - block_ < 64 ? str_.size() - block_ : 64;
+        newlines_ = byte_mask('\n', str_.data() + block_, n);
+    }
+
+    // the position of the next newline, str_.size() if there is none
+    constexpr std::size_t next_newline() noexcept {
+        while (newlines_ == 0) {
+            block_ += 64;
+            if (block_ >= str_.size())
+                return str_.size();
+            load();
+        }
+        auto const i = block_ + static_cast<std::size_t>(countr_zero(newlines_));
+        newlines_ &= newlines_ - 1;
+        return i;
+    }
+
+    std::string_view str_{};
+    line_options options_{};
+    std::size_t pos_{};
+    std::size_t number_{};
+    std::size_t block_{};
+    std::uint64_t newlines_{};  // newlines in the block at block_ not yet reported
+};
+
+} // namespace detail
+
+// lines_view - a lazy range over the lines of a string, by default a \r
+// before the newline is dropped and empty lines are kept, each line
+// carries its line number and offset
+class lines_view {
+public:
+    class sentinel {};
+
+    class iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = text_line;
+        using difference_type = std::ptrdiff_t;
+        using pointer = text_line const*;
+        using reference = text_line const&;
+
+        constexpr iterator() noexcept = default;
+
+        constexpr explicit iterator(detail::line_scanner const& scanner) noexcept
+            : scanner_{scanner}
+        {
+            advance();
+        }
+
+        [[nodiscard]] constexpr reference operator*() const noexcept { return line_; }
+        [[nodiscard]] constexpr pointer operator->() const noexcept { return &line_; }
+
+        constexpr iterator& operator++() noexcept {
+            advance();
+            return *this;
+        }
+
+        constexpr iterator operator++(int) noexcept {
+            auto saved{*this};
+            advance();
+            return saved;
+        }
+
+        friend constexpr bool operator==(iterator const& lhs, iterator const& rhs) noexcept {
+            return lhs.done_ == rhs.done_ && lhs.line_.number == rhs.line_.number;
+        }
+
+        friend constexpr bool operator!=(iterator const& lhs, iterator const& rhs) noexcept {
+            return !(lhs == rhs);
+        }
+
+        friend constexpr bool operator==(iterator const& it, sentinel) noexcept { return it.done_; }
+        friend constexpr bool operator==(sentinel, iterator const& it) noexcept { return it.done_; }
+        friend constexpr bool operator!=(iterator const& it, sentinel) noexcept { return !it.done_; }
+        friend constexpr bool operator!=(sentinel, iterator const& it) noexcept { return !it.done_; }
+
+    private:
+        constexpr void advance() noexcept {
+            done_ = !scanner_.next(line_);
+            if (done_)
+                line_ = {};
+        }
+
+        detail::line_scanner scanner_{};
+        text_line line_{};
+        bool done_{true};
+    };
+
+    constexpr explicit lines_view(std::string_view const str, line_options const options = line_options::none) noexcept
+        : str_{str}
+        , options_{options}
+    {}
+
+    [[nodiscard]] constexpr iterator begin() const noexcept { return iterator{detail::line_scanner{str_, options_}}; }
+    [[nodiscard]] constexpr sentinel end() const noexcept { return {}; }
+
+private:
+    std::string_view str_;
+    line_options options_;
+};
+
+// e.g. for (auto const [text, number, offset] : lines("a\r\n\nb")) yields
+//      {"a", 1, 0}, {"", 2, 3}, {"b", 3, 4}
+[[nodiscard]] constexpr lines_view lines(std::string_view const str, line_options const options = line_options::none) noexcept {
+    return lines_view{str, options};
+}
+
+// csv_field - a field of a csv/tsv record as it appears in the input
+struct csv_field {
+    std::string_view raw{};
+    bool end_of_record{};
+
+    [[nodiscard]] constexpr bool quoted() const noexcept {
+        return raw.size() >= 2 && raw.front() == '"' && raw.back() == '"';
+    }
+
+    // the field without its enclosing quotes, escaped quotes stay doubled
+    [[nodiscard]] constexpr std::string_view value() const noexcept {
+        return quoted() ? raw.substr(1, raw.size() - 2) : raw;
+    }
+
+    // writes value() with every doubled quote collapsed to one
+    template<class OutIter>
+    constexpr OutIter unescape(OutIter out) const {
+        auto const v = value();
+        for (std::size_t i = 0; i < v.size(); ++i) {
+            *out++ = v[i];
+            if (v[i] == '"' && i + 1 < v.size() && v[i + 1] == '"')
+                ++i;
+        }
+        return out;
+    }
+
+    [[nodiscard]] std::string unescaped() const {
+        std::string ret{};
+        ret.reserve(value().size());
+        unescape(std::back_inserter(ret));
+        return ret;
+    }
+};
+
+namespace detail {
+
+// bit i of the result is the xor of bits [0, i] of x, i.e. set inside quotes
+constexpr std::uint64_t prefix_xor(std::uint64_t x) noexcept {
+#if defined(EXTRA_STRING_X86_SIMD) && defined(__PCLMUL__)
+    if (!is_constant_evaluated())
+        return static_cast<std::uint64_t>(_mm_cvtsi128_si64(
+            _mm_clmulepi64_si128(_mm_set_epi64x(0, static_cast<long long>(x)), _mm_set1_epi8(-1), 0)));
+#endif
+    x ^= x << 1;
+    x ^= x << 2;
+    x ^= x << 4;
+    x ^= x << 8;
+    x ^= x << 16;
+    x ^= x << 32;
+    return x;
+}
+
+// csv_scanner - splits csv one 64 byte block at a time, quote regions are
+// found by a prefix xor over the quote mask, so separators inside quotes
+// are discarded without a per byte state machine
+class csv_scanner {
+public:
+    constexpr csv_scanner() noexcept = default;
+
+    constexpr csv_scanner(std::string_view const str, char const delim) noexcept
+        : str_{str}
+        , delim_{delim}
+    {}
+
+    // stores the next field, returns false once str is exhausted
+    constexpr bool next(csv_field& field) noexcept {
+        for (;;) {
+            if (seps_ != 0) {
+                auto const i = pos_ + static_cast<std::size_t>(countr_zero(seps_));
+                seps_ &= seps_ - 1;
+                auto const newline = str_[i] == '\n';
+                auto end = i;
+                if (newline && end > start_ && str_[end - 1] == '\r')
+                    --end;
+                field = csv_field{str_.substr(start_, end - start_), newline};
+                start_ = i + 1;
+                trailing_ = !newline;
+                return true;
+            }
+            if (next_ >= str_.size()) {
+                if (start_ >= str_.size() && !trailing_)
+                    return false;
+                field = csv_field{str_.substr(start_), true};
+                start_ = str_.size();
+                trailing_ = false;
+                return true;
+            }
+            load();
+        }
+    }
+
+private:
+    constexpr void load() noexcept {
+        pos_ = next_;
+        auto const n = str_.size() - pos_ < 64 ? str_.size() - pos_ : 64;
+        auto const p = str_.data() + pos_;
+        auto const quoted = prefix_xor(byte_mask('"', p, n)) ^ in_quote_;
+        seps_ = (byte_mask(delim_, p, n) | byte_mask('\n', p, n)) & ~quoted;
+        // all ones if the block ends inside a quote
+        in_quote_ = std::uint64_t{0} - ((quoted >> (n - 1)) & 1);
+        next_ = pos_ + n;
+    }
+
+    std::string_view str_{};
+    char delim_{','};
+    std::size_t pos_{};
+    std::size_t next_{};
+    std::size_t start_{};
+    std::uint64_t seps_{};      // separators outside quotes not yet reported
+    std::uint64_t in_quote_{};
+    bool trailing_{};           // the last separator was a delimiter, a final field follows it
+};
+
+} // namespace detail
+
+// csv_view - a lazy range over the fields of csv/tsv text (RFC 4180 quoting)
+// fields are split on delim and on newlines outside quotes, a \r before a
+// newline is dropped, empty fields are kept and nothing is copied
+class csv_view {
+public:
+    class sentinel {};
+
+    class iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = csv_field;
+        using difference_type = std::ptrdiff_t;
+        using pointer = csv_field const*;
+        using reference = csv_field const&;
+
+        constexpr iterator() noexcept = default;
+
+        constexpr explicit iterator(detail::csv_scanner const& scanner) noexcept
+            : scanner_{scanner}
+        {
+            advance();
+        }
+
+        [[nodiscard]] constexpr reference operator*() const noexcept { return field_; }
+        [[nodiscard]] constexpr pointer operator->() const noexcept { return &field_; }
+
+        constexpr iterator& operator++() noexcept {
+            advance();
+            return *this;
+        }
+
+        constexpr iterator operator++(int) noexcept {
+            auto saved{*this};
+            advance();
+            return saved;
+        }
+
+        friend constexpr bool operator==(iterator const& lhs, iterator const& rhs) noexcept {
+            return lhs.done_ == rhs.done_ && lhs.field_.raw.data() == rhs.field_.raw.data();
+        }
+
+        friend constexpr bool operator!=(iterator const& lhs, iterator const& rhs) noexcept {
+            return !(lhs == rhs);
+        }
+
+        friend constexpr bool operator==(iterator const& it, sentinel) noexcept { return it.done_; }
+        friend constexpr bool operator==(sentinel, iterator const& it) noexcept { return it.done_; }
+        friend constexpr bool operator!=(iterator const& it, sentinel) noexcept { return !it.done_; }
+        friend constexpr bool operator!=(sentinel, iterator const& it) noexcept { return !it.done_; }
+
+    private:
+        constexpr void advance() noexcept {
+            done_ = !scanner_.next(field_);
+            if (done_)
+                field_ = {};
+        }
+
+        detail::csv_scanner scanner_{};
+        csv_field field_{};
+        bool done_{true};
+    };
+
+    constexpr explicit csv_view(std::string_view const str, char const delim = ',') noexcept
+        : str_{str}
+        , delim_{delim}
+    {}
+
+    [[nodiscard]] constexpr iterator begin() const noexcept { return iterator{detail::csv_scanner{str_, delim_}}; }
+    [[nodiscard]] constexpr sentinel end() const noexcept { return {}; }
+
+private:
+    std::string_view str_;
+    char delim_;
+};
+
+// e.g. csv_fields("a,\"b,c\"\n") yields "a", "\"b,c\""
+[[nodiscard]] constexpr csv_view csv_fields(std::string_view const str, char const delim = ',') noexcept {
+    return csv_view{str, delim};
+}
+
+namespace detail {
+
+// the value of a hex digit, -1 if c is not one
+constexpr int hex_digit(char const c) noexcept {
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+    return -1;
+}
+
+} // namespace detail
+
+// writes str with every %XX escape replaced by the byte it encodes, and
+// with '+' replaced by a space if plus_as_space (form encoding),
+// malformed escapes are copied unchanged
+template<class OutIter>
+constexpr OutIter percent_decode(std::string_view const str, OutIter out, bool const plus_as_space = false) {
+    std::string_view const special = plus_as_space ? "%+" : "%";
+    std::size_t pos{};
+    for (auto i = str.find_first_of(special); i != std::string_view::npos; i = str.find_first_of(special, pos)) {
+        out = std::copy(str.begin() + pos, str.begin() + i, out);
+        pos = i + 1;
+        if (str[i] == '+') {
+            *out++ = ' ';
+            continue;
+        }
+        auto const hi = i + 2 < str.size() ? detail::hex_digit(str[i + 1]) : -1;
+        auto const lo = hi < 0 ? -1 : detail::hex_digit(str[i + 2]);
+        if (lo < 0) {
+            *out++ = '%';
+            continue;
+        }
+        *out++ = static_cast<char>(hi * 16 + lo);
+        pos = i + 3;
+    }
+    return std::copy(str.begin() + pos, str.end(), out);
+}
+
+// kv_pair - a key=value pair as it appears in the input
+struct kv_pair {
+    std::string_view key{};
+    std::string_view value{};
+
+    // the pair form decoded ('+' is a space, %XX a byte) into buffer, the
+    // views point into buffer unless nothing needed decoding, in which case
+    // the pair is returned as is and buffer is left untouched
+    [[nodiscard]] kv_pair decoded(std::string& buffer) const {
+        if (key.find_first_of("%+") == std::string_view::npos && value.find_first_of("%+") == std::string_view::npos)
+            return *this;
+        buffer.clear();
+        buffer.reserve(key.size() + value.size());
+        percent_decode(key, std::back_inserter(buffer), true);
+        auto const key_size = buffer.size();
+        percent_decode(value, std::back_inserter(buffer), true);
+        std::string_view const str{buffer};
+        return {str.substr(0, key_size), str.substr(key_size)};
+    }
+};
+
+namespace detail {
+
+// kv_scanner - splits key=value pairs in a single pass, a key is ended by
+// the first key or pair delimiter and its value by the next pair delimiter,
+// so every byte is classified once by the vectorized delimiter search
+class kv_scanner {
+public:
+    constexpr kv_scanner() noexcept = default;
+
+    constexpr kv_scanner(std::string_view const str, delimiter_set const& pair_delims, char const kv_delim) noexcept
+        : str_{str}
+        , pairs_{pair_delims}
+        , any_{pair_delims}
+    {
+        any_.insert(kv_delim);
+    }
+
+    // stores the next non-empty pair, returns false once str is exhausted
+    constexpr bool next(kv_pair& pair) noexcept {
+        while (pos_ < str_.size()) {
+            auto const key_end = std::min(any_.find_first_of(str_, pos_), str_.size());
+            if (key_end == str_.size() || pairs_.contains(str_[key_end])) {
+                if (key_end == pos_) {
+                    ++pos_;
+                    continue;
+                }
+                // a pair without a kv delimiter is a key with an empty value
+                pair = {str_.substr(pos_, key_end - pos_), {}};
+                pos_ = key_end + 1;
+                return true;
+            }
+            auto const value_end = std::min(pairs_.find_first_of(str_, key_end + 1), str_.size());
+            pair = {str_.substr(pos_, key_end - pos_), str_.substr(key_end + 1, value_end - key_end - 1)};
+            pos_ = value_end + 1;
+            return true;
+        }
+        return false;
+    }
+
+private:
+    std::string_view str_{};
+    std::size_t pos_{};
+    delimiter_set pairs_{};
+    delimiter_set any_{};       // pairs_ and the kv delimiter
+};
+
+} // namespace detail
+
+// kv_view - a lazy range over the key=value pairs of a string, such as a
+// query string or a config line, keys and values are views into the string
+// and empty pairs are skipped
+class kv_view {
+public:
+    class sentinel {};
+
+    class iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = kv_pair;
+        using difference_type = std::ptrdiff_t;
+        using pointer = kv_pair const*;
+        using reference = kv_pair const&;
+
+        constexpr iterator() noexcept = default;
+
+        constexpr explicit iterator(detail::kv_scanner const& scanner) noexcept
+            : scanner_{scanner}
+        {
+            advance();
+        }
+
+        [[nodiscard]] constexpr reference operator*() const noexcept { return pair_; }
+        [[nodiscard]] constexpr pointer operator->() const noexcept { return &pair_; }
+
+        constexpr iterator& operator++() noexcept {
+            advance();
+            return *this;
+        }
+
+        constexpr iterator operator++(int) noexcept {
+            auto saved{*this};
+            advance();
+            return saved;
+        }
+
+        friend constexpr bool operator==(iterator const& lhs, iterator const& rhs) noexcept {
+            return lhs.done_ == rhs.done_ && lhs.pair_.key.data() == rhs.pair_.key.data();
+        }
+
+        friend constexpr bool operator!=(iterator const& lhs, iterator const& rhs) noexcept {
+            return !(lhs == rhs);
+        }
+
+        friend constexpr bool operator==(iterator const& it, sentinel) noexcept { return it.done_; }
+        friend constexpr bool operator==(sentinel, iterator const& it) noexcept { return it.done_; }
+        friend constexpr bool operator!=(iterator const& it, sentinel) noexcept { return !it.done_; }
+        friend constexpr bool operator!=(sentinel, iterator const& it) noexcept { return !it.done_; }
+
+    private:
+        constexpr void advance() noexcept {
+            done_ = !scanner_.next(pair_);
+            if (done_)
+                pair_ = {};
+        }
+
+        detail::kv_scanner scanner_{};
+        kv_pair pair_{};
+        bool done_{true};
+    };
+
+    constexpr kv_view(std::string_view const str, delimiter_set const& pair_delims, char const kv_delim) noexcept
+        : str_{str}
+        , pairs_{pair_delims}
+        , kv_{kv_delim}
+    {}
+
+    [[nodiscard]] constexpr iterator begin() const noexcept { return iterator{detail::kv_scanner{str_, pairs_, kv_}}; }
+    [[nodiscard]] constexpr sentinel end() const noexcept { return {}; }
+
+    // the value of the first pair with the given key, scanning stops there
+    [[nodiscard]] constexpr std::optional<std::string_view> find(std::string_view const key) const noexcept {
+        detail::kv_scanner scanner{str_, pairs_, kv_};
+        for (kv_pair pair{}; scanner.next(pair);)
+            if (pair.key == key)
+                return pair.value;
+        return std::nullopt;
+    }
+
+private:
+    std::string_view str_;
+    delimiter_set pairs_;
+    char kv_;
+};
+
+// e.g. kv_range("a=1&b=2") yields {"a", "1"}, {"b", "2"}
+//      kv_range("x:1; y:2", "; ", ':') yields {"x", "1"}, {"y", "2"}
+[[nodiscard]] constexpr kv_view kv_range(std::string_view const str, delimiter_set const& pair_delims = delimiter_set{"&"}, char const kv_delim = '=') noexcept {
+    return kv_view{str, pair_delims, kv_delim};
+}
+
+[[nodiscard]] constexpr kv_view kv_range(std::string_view const str, std::string_view const pair_delims, char const kv_delim = '=') noexcept {
+    return kv_view{str, delimiter_set{pair_delims}, kv_delim};
+}
+
+namespace detail {
+
+// parses 8 ascii digits at once (swar), p must point to 8 readable bytes
+// returns false if any of them is not a digit
+inline bool parse_eight_digits(char const* p, std::uint64_t& value) noexcept {
+    std::uint64_t w{};
+    std::memcpy(&w, p, sizeof(w));
+    // every byte must be in ['0', '9']: high nibble 3 and low nibble + 6 must not carry
+    if ((w & 0xf0f0f0f0f0f0f0f0) != 0x3030303030303030 ||
+        ((w + 0x0606060606060606) & 0xf0f0f0f0f0f0f0f0) != 0x3030303030303030)
+        return false;
+    w -= 0x3030303030303030;
+    w = (w * 10) + (w >> 8);
+    w = (((w & 0x000000ff000000ff) * (100 + (1000000ull << 32))) +
+        (((w >> 16) & 0x000000ff000000ff) * (1 + (10000ull << 32)))) >> 32;
+    value = w;
+    return true;
+}
+
+// parses the whole of str as a T, like std::from_chars but rejecting trailing characters
+// integers of up to 19 digits take an 8 digits at a time fast path
+template<class T>
+std::errc parse_token(std::string_view const str, T& value) noexcept {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    if constexpr (std::is_integral_v<T> && !std::is_same_v<T, bool>) {
+        bool const negative = std::is_signed_v<T> && !str.empty() && str[0] == '-';
+        auto const digits = str.substr(negative ? 1 : 0);
+        if (!digits.empty() && digits.size() <= 19) {
+            std::uint64_t v{};
+            std::size_t i{};
+            bool valid = true;
+            for (std::uint64_t eight{}; valid && digits.size() - i >= 8; i += 8) {
+                valid = parse_eight_digits(digits.data() + i, eight);
+                v = v * 100000000 + eight;
+            }
+            for (; valid && i < digits.size(); ++i) {
+                auto const d = static_cast<unsigned char>(digits[i] - '0');
+                valid = d <= 9;
+                v = v * 10 + d;
+            }
+            if (valid) {
+                using unsigned_t = std::make_unsigned_t<T>;
+                auto const max = static_cast<std::uint64_t>(static_cast<unsigned_t>(std::numeric_limits<T>::max()));
+                if (v > max + (negative ? 1 : 0))
+                    return std::errc::result_out_of_range;
+                value = negative ? static_cast<T>(0 - static_cast<unsigned_t>(v)) : static_cast<T>(v);
+                return std::errc{};
+            }
+        }
+    }
+#endif
+    auto const [ptr, ec] = std::from_chars(str.data(), str.data() + str.size(), value);
+    if (ec == std::errc{} && ptr != str.data() + str.size())
+        return std::errc::invalid_argument;
+    return ec;
+}
+
+struct ignore_parse_error {
+    constexpr void operator()(std::size_t, std::string_view, std::errc) const noexcept {}
+};
+
+} // namespace detail
+
+// parse_tokens - tokenizes str and parses every token as a T in one pass
+// parsed values are written to out, for a token that fails to parse
+// on_error(index, token, errc) is called instead and nothing is written
+// e.g. parse_tokens<int>("1 2 x 3", " ", std::back_inserter(vec)) -> {1, 2, 3}
+template<class T, class OutIter, class ErrorFn = detail::ignore_parse_error>
+OutIter parse_tokens(std::string_view const str, delimiter_set const& delims, OutIter out, ErrorFn on_error = {}) {
+    detail::token_scanner<delimiter_set> scanner{str, delims};
+    std::size_t index{};
+    for (std::size_t begin{}, end{}; scanner.next(begin, end); ++index) {
+        auto const token = str.substr(begin, end - begin);
+        T value{};
+        if (auto const ec = detail::parse_token(token, value); ec == std::errc{})
+            *out++ = value;
+        else
+            on_error(index, token, ec);
+    }
+    return out;
+}
+
+template<class T, class OutIter, class ErrorFn = detail::ignore_parse_error>
+OutIter parse_tokens(std::string_view const str, std::string_view const delims, OutIter out, ErrorFn on_error = {}) {
+    return parse_tokens<T>(str, delimiter_set{delims}, std::move(out), std::move(on_error));
+}
+
+namespace detail {
+
+// written out byte by byte so it stays constexpr, compilers fold it into one load
+constexpr std::uint64_t load_le32(char const* p) noexcept {
+    return static_cast<std::uint64_t>(static_cast<unsigned char>(p[0])) |
+        static_cast<std::uint64_t>(static_cast<unsigned char>(p[1])) << 8 |
+        static_cast<std::uint64_t>(static_cast<unsigned char>(p[2])) << 16 |
+        static_cast<std::uint64_t>(static_cast<unsigned char>(p[3])) << 24;
+}
+
+constexpr std::uint64_t load_le64(char const* p) noexcept {
+    return load_le32(p) | load_le32(p + 4) << 32;
+}
+
+// folded 64x64 -> 128 bit multiply, the portable path gives the same bits
+constexpr std::uint64_t hash_mix(std::uint64_t const a, std::uint64_t const b) noexcept {
+#if defined(__SIZEOF_INT128__)
+    __extension__ typedef unsigned __int128 uint128;
+    auto const r = static_cast<uint128>(a) * b;
+    return static_cast<std::uint64_t>(r) ^ static_cast<std::uint64_t>(r >> 64);
+#else
+    constexpr std::uint64_t low = 0xffffffff;
+    auto const lo_lo = (a & low) * (b & low);
+    auto const hi_lo = (a >> 32) * (b & low);
+    auto const lo_hi = (a & low) * (b >> 32);
+    auto const hi_hi = (a >> 32) * (b >> 32);
+    auto const cross = (lo_lo >> 32) + (hi_lo & low) + lo_hi;
+    auto const hi = hi_hi + (hi_lo >> 32) + (cross >> 32);
+    auto const lo = (cross << 32) | (lo_lo & low);
+    return lo ^ hi;
+#endif
+}
+
+// every ascii upper case byte of w lowered, one 8 byte word at a time (swar)
+constexpr std::uint64_t ascii_lower64(std::uint64_t const w) noexcept {
+    constexpr std::uint64_t ones = 0x0101010101010101;
+    auto const low7 = w & (0x7f * ones);
+    // the high bit of each byte is set iff its low 7 bits are >= 'A', resp. > 'Z'
+    auto const ge_a = low7 + (0x80 - 'A') * ones;
+    auto const gt_z = low7 + (0x80 - 'Z' - 1) * ones;
+    auto const upper = (ge_a ^ gt_z) & ~w & (0x80 * ones);
+    return w | (upper >> 2);
+}
+
+constexpr char ascii_lower(char const c) noexcept {
+    return c >= 'A' && c <= 'Z' ? static_cast<char>(c + ('a' - 'A')) : c;
+}
+
+// a fast non-cryptographic hash consuming 8 bytes per step, the
+// tail is read with overlapping loads instead of a byte loop
+// with Fold the bytes are ascii lowered first, so strings equal
+// ignoring ascii case hash the same
+template<bool Fold = false>
+constexpr std::uint64_t hash_bytes(std::string_view const str, std::uint64_t const seed = 0) noexcept {
+    constexpr std::uint64_t k0 = 0xa0761d6478bd642f;
+    constexpr std::uint64_t k1 = 0xe7037ed1a0b428db;
+    constexpr std::uint64_t k2 = 0x8ebc6af09c88c6e3;
+    auto const fold = [](std::uint64_t const w) { return Fold ? ascii_lower64(w) : w; };
+    auto const size = str.size();
+    auto h = seed ^ hash_mix(size ^ k0, k1);
+    std::uint64_t a{}, b{};
+    if (size > 8) {
+        auto p = str.data();
+        for (auto n = size; n > 8; p += 8, n -= 8)
+            h = hash_mix(h ^ fold(load_le64(p)), k1);
+        a = fold(load_le64(str.data() + size - 8));
+    }
+    else if (size >= 4) {
+        a = fold(load_le32(str.data()));
+        b = fold(load_le32(str.data() + size - 4));
+    }
+    else if (size > 0) {
+        auto const p = str.data();
+        a = fold(static_cast<std::uint64_t>(static_cast<unsigned char>(p[0])) << 16 |
+            static_cast<std::uint64_t>(static_cast<unsigned char>(p[size / 2])) << 8 |
+            static_cast<std::uint64_t>(static_cast<unsigned char>(p[size - 1])));
+    }
+    h = hash_mix(h ^ a, k2 ^ b);
+    return hash_mix(h, k0);
+}
+
+// string_arena - copies strings into blocks that are never moved
+// blocks start small and double up to block_size, so a lightly used arena
+// stays small, strings larger than block_size get a block of their own
+class string_arena {
+public:
+    static constexpr std::size_t first_block_size = 256;
+
+    explicit string_arena(std::size_t const block_size = 64 * 1024) noexcept
+        : block_size_{block_size}
+    {}
+
+    string_arena(string_arena&& other) noexcept
+        : block_size_{other.block_size_}
+        , current_{std::exchange(other.current_, nullptr)}
+        , capacity_{std::exchange(other.capacity_, 0)}
+        , used_{std::exchange(other.used_, 0)}
+        , next_{std::exchange(other.next_, 0)}
+        , blocks_{std::move(other.blocks_)}
+        , large_{std::move(other.large_)}
+    {}
+
+    string_arena& operator=(string_arena&& other) noexcept {
+        block_size_ = other.block_size_;
+        current_ = std::exchange(other.current_, nullptr);
+        capacity_ = std::exchange(other.capacity_, 0);
+        used_ = std::exchange(other.used_, 0);
+        next_ = std::exchange(other.next_, 0);
+        blocks_ = std::move(other.blocks_);
+        large_ = std::move(other.large_);
+        return *this;
+    }
+
+    // consecutive strings that fit in the current block are stored contiguously
+    std::string_view store(std::string_view const str) {
+        if (str.size() > block_size_) {
+            large_.push_back(std::make_unique<char[]>(str.size()));
+            std::memcpy(large_.back().get(), str.data(), str.size());
+            return {large_.back().get(), str.size()};
+        }
+        if (str.empty())
+            return {current_, 0};
+        if (str.size() > capacity_ - used_)
+            next_block(str.size());
+        auto const data = current_ + used_;
+        std::memcpy(data, str.data(), str.size());
+        used_ += str.size();
+        return {data, str.size()};
+    }
+
+    // invalidates all stored strings but keeps the blocks for reuse,
+    // only strings larger than a block had blocks of their own to free
+    void reset() noexcept {
+        large_.clear();
+        current_ = nullptr;
+        capacity_ = 0;
+        used_ = 0;
+        next_ = 0;
+    }
+
+    // releases every block, invalidating all stored strings
+    void clear() noexcept {
+        blocks_.clear();
+        reset();
+    }
+
+private:
+    struct block {
+        std::unique_ptr<char[]> data;
+        std::size_t size;
+    };
+
+    // the next kept block with room for n bytes, or a new one twice the size of the last
+    void next_block(std::size_t const n) {
+        while (next_ < blocks_.size() && blocks_[next_].size < n)
+            ++next_;
+        if (next_ == blocks_.size()) {
+            auto const size = blocks_.empty() ? first_block_size : 2 * blocks_.back().size;
+            auto const capped = std::max(n, std::min(size, block_size_));
+            blocks_.push_back({std::make_unique<char[]>(capped), capped});
+        }
+        current_ = blocks_[next_].data.get();
+        capacity_ = blocks_[next_].size;
+        used_ = 0;
+        ++next_;
+    }
+
+    std::size_t block_size_;
+    char* current_{};
+    std::size_t capacity_{};            // the size of the current block
+    std::size_t used_{};
+    std::size_t next_{};                // the block that follows current_
+    std::vector<block> blocks_;
+    std::vector<std::unique_ptr<char[]>> large_;
+};
+
+} // namespace detail
+
+struct intern_pool_stats {
+    std::size_t lookups{};      // calls to intern
+    std::size_t hits{};         // calls to intern that found an existing string
+    std::size_t bytes_stored{}; // bytes of distinct strings in the arena
+    std::size_t bytes_saved{};  // bytes that hits did not have to store again
+
+    [[nodiscard]] constexpr double hit_rate() const noexcept {
+        return lookups == 0 ? 0.0 : static_cast<double>(hits) / static_cast<double>(lookups);
+    }
+};
+
+// intern_pool - stores every distinct string once in an arena
+// intern returns a dense 32-bit id, view(id) the stored string,
+// both stay valid until the pool is destroyed, intern throws
+// std::length_error once every id is taken
+class intern_pool {
+public:
+    using id_type = std::uint32_t;
+
+    explicit intern_pool(std::size_t const block_size = 64 * 1024)
+        : arena_{block_size}
+    {}
+
+    id_type intern(std::string_view const str) {
+        return intern(str, detail::hash_bytes(str));
+    }
+
+    std::string_view intern_view(std::string_view const str) {
+        return view(intern(str));
+    }
+
+    [[nodiscard]] std::optional<id_type> find(std::string_view const str) const noexcept {
+        return find(str, detail::hash_bytes(str));
+    }
+
+    [[nodiscard]] std::string_view view(id_type const id) const noexcept { return strings_[id]; }
+
+    [[nodiscard]] std::size_t size() const noexcept { return strings_.size(); }
+    [[nodiscard]] bool empty() const noexcept { return strings_.empty(); }
+
+    [[nodiscard]] intern_pool_stats const& stats() const noexcept { return stats_; }
+
+private:
+    friend class concurrent_intern_pool;
+
+    static constexpr id_type empty_slot = ~id_type{};
+
+    [[nodiscard]] std::optional<id_type> find(std::string_view const str, std::uint64_t const hash) const noexcept {
+        if (slots_.empty())
+            return std::nullopt;
+        auto const mask = slots_.size() - 1;
+        for (auto i = static_cast<std::size_t>(hash) & mask;; i = (i + 1) & mask) {
+            auto const id = slots_[i];
+            if (id == empty_slot)
+                return std::nullopt;
+            if (hashes_[id] == hash && strings_[id] == str)
+                return id;
+        }
+    }
+
+    // limit is the number of distinct strings that can be given an id
+    id_type intern(std::string_view const str, std::uint64_t const hash, std::size_t const limit = empty_slot) {
+        ++stats_.lookups;
+        if (auto const id = find(str, hash)) {
+            ++stats_.hits;
+            stats_.bytes_saved += str.size();
+            return *id;
+        }
+        if (strings_.size() >= limit)
+            throw std::length_error{"intern_pool: out of ids"};
+
+        // keep the load factor at or below 1/2
+        if (2 * (strings_.size() + 1) > slots_.size())
+            rehash(slots_.empty() ? 64 : 2 * slots_.size());
+
+        auto const id = static_cast<id_type>(strings_.size());
+        strings_.push_back(arena_.store(str));
+        hashes_.push_back(hash);
+        insert_slot(id);
+        stats_.bytes_stored += str.size();
+        return id;
+    }
+
+    void insert_slot(id_type const id) noexcept {
+        auto const mask = slots_.size() - 1;
+        auto i = static_cast<std::size_t>(hashes_[id]) & mask;
+        while (slots_[i] != empty_slot)
+            i = (i + 1) & mask;
+        slots_[i] = id;
+    }
+
+    void rehash(std::size_t const capacity) {
+        slots_.assign(capacity, empty_slot);
+        for (id_type id = 0; id < strings_.size(); ++id)
+            insert_slot(id);
+    }
+
+    detail::string_arena arena_;
+    std::vector<std::string_view> strings_;
+    std::vector<std::uint64_t> hashes_;
+    std::vector<id_type> slots_;
+    intern_pool_stats stats_;
+};
+
+// concurrent_intern_pool - a thread-safe intern_pool sharded by hash
+// each shard is an intern_pool behind its own mutex, the shard
+// index lives in the low bits of the returned ids, so a shard holds
+// at most 2^(32 - log2(shard_count)) strings before intern throws std::length_error
+class concurrent_intern_pool {
+public:
+    using id_type = intern_pool::id_type;
+
+    // shard_count is rounded up to a power of two
+    explicit concurrent_intern_pool(std::size_t const shard_count = 16, std::size_t const block_size = 64 * 1024)
+        : shift_{shard_shift(shard_count)}
+        , shards_(std::size_t{1} << shift_)
+    {
+        for (auto& shard : shards_)
+            shard.pool = intern_pool{block_size};
+    }
+
+    id_type intern(std::string_view const str) {
+        auto const hash = detail::hash_bytes(str);
+        auto const index = shard_index(hash);
+        auto& shard = shards_[index];
+        std::lock_guard<std::mutex> const lock{shard.mutex};
+        auto const local = shard.pool.intern(str, hash, std::min<std::size_t>(std::size_t{1} << (32 - shift_), intern_pool::empty_slot));
+        return static_cast<id_type>((std::size_t{local} << shift_) | index);
+    }
+
+    std::string_view intern_view(std::string_view const str) {
+        return view(intern(str));
+    }
+
+    [[nodiscard]] std::optional<id_type> find(std::string_view const str) const {
+        auto const hash = detail::hash_bytes(str);
+        auto const index = shard_index(hash);
+        auto const& shard = shards_[index];
+        std::lock_guard<std::mutex> const lock{shard.mutex};
+        if (auto const id = shard.pool.find(str, hash))
+            return static_cast<id_type>((*id << shift_) | index);
+        return std::nullopt;
+    }
+
+    [[nodiscard]] std::string_view view(id_type const id) const {
+        auto const& shard = shards_[id & ((id_type{1} << shift_) - 1)];
+        std::lock_guard<std::mutex> const lock{shard.mutex};
+        return shard.pool.view(id >> shift_);
+    }
+
+    [[nodiscard]] intern_pool_stats stats() const {
+        intern_pool_stats ret{};
+        for (auto const& shard : shards_) {
+            std::lock_guard<std::mutex> const lock{shard.mutex};
+            ret.lookups += shard.pool.stats().lookups;
+            ret.hits += shard.pool.stats().hits;
+            ret.bytes_stored += shard.pool.stats().bytes_stored;
+            ret.bytes_saved += shard.pool.stats().bytes_saved;
+        }
+        return ret;
+    }
+
+private:
+    struct shard {
+        mutable std::mutex mutex;
+        intern_pool pool;
+    };
+
+    static constexpr id_type shard_shift(std::size_t const shard_count) noexcept {
+        id_type shift{};
+        while ((std::size_t{1} << shift) < shard_count)
+            ++shift;
+        return shift;
+    }
+
+    [[nodiscard]] std::size_t shard_index(std::uint64_t const hash) const noexcept {
+        // the high bits, the low ones pick the slot within the shard
+        return shift_ == 0 ? 0 : static_cast<std::size_t>(hash >> (64 - shift_));
+    }
+
+    id_type shift_;
+    std::vector<shard> shards_;
+};
+
+namespace detail {
+
+// compares n bytes ignoring ascii case, 8 at a time with the last word overlapping
+constexpr bool iequals_swar(char const* const a, char const* const b, std::size_t const n) noexcept {
+    if (n < 8) {
+        for (std::size_t i = 0; i < n; ++i)
+            if (ascii_lower(a[i]) != ascii_lower(b[i]))
+                return false;
+        return true;
+    }
+    for (std::size_t i = 0; i + 8 < n; i += 8)
+        if (ascii_lower64(load_le64(a + i)) != ascii_lower64(load_le64(b + i)))
+            return false;
+    return ascii_lower64(load_le64(a + n - 8)) == ascii_lower64(load_le64(b + n - 8));
+}
+
+#if defined(__SSE2__)
+
+// bytes in ['A', 'Z'] are moved to [-128, -103] so one signed compare finds them
+inline __m128i ascii_lower16(__m128i const x) noexcept {
+    __m128i const shifted = _mm_add_epi8(x, _mm_set1_epi8(static_cast<char>(0x80 - 'A')));
+    __m128i const upper = _mm_cmplt_epi8(shifted, _mm_set1_epi8(static_cast<char>(0x80 + 26)));
+    return _mm_or_si128(x, _mm_and_si128(upper, _mm_set1_epi8(0x20)));
+}
+
+// bit i is set iff the lowered haystack bytes i and i + m - 1 are first and last
+inline std::uint32_t ifind_candidates16(char const* const p, std::size_t const m, char const first, char const last) noexcept {
+    __m128i const head = ascii_lower16(_mm_loadu_si128(reinterpret_cast<__m128i const*>(p)));
+    __m128i const tail = ascii_lower16(_mm_loadu_si128(reinterpret_cast<__m128i const*>(p + m - 1)));
+    return static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_and_si128(
+        _mm_cmpeq_epi8(head, _mm_set1_epi8(first)), _mm_cmpeq_epi8(tail, _mm_set1_epi8(last)))));
+}
+
+#endif // __SSE2__
+
+#if defined(__AVX2__)
+
+inline __m256i ascii_lower32(__m256i const x) noexcept {
+    __m256i const shifted = _mm256_add_epi8(x, _mm256_set1_epi8(static_cast<char>(0x80 - 'A')));
+    __m256i const upper = _mm256_cmpgt_epi8(_mm256_set1_epi8(static_cast<char>(0x80 + 26)), shifted);
+    return _mm256_or_si256(x, _mm256_and_si256(upper, _mm256_set1_epi8(0x20)));
+}
+
+inline std::uint32_t ifind_candidates32(char const* const p, std::size_t const m, char const first, char const last) noexcept {
+    __m256i const head = ascii_lower32(_mm256_loadu_si256(reinterpret_cast<__m256i const*>(p)));
+    __m256i const tail = ascii_lower32(_mm256_loadu_si256(reinterpret_cast<__m256i const*>(p + m - 1)));
+    return static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_and_si256(
+        _mm256_cmpeq_epi8(head, _mm256_set1_epi8(first)), _mm256_cmpeq_epi8(tail, _mm256_set1_epi8(last)))));
+}
+
+#endif // __AVX2__
+
+// the widest vectors the build targets compare 32 or 16 bytes per step,
+// these are chosen at compile time since the strings compared are short
+inline bool iequals_vectorized(char const* const a, char const* const b, std::size_t const n) noexcept {
+#if defined(__AVX2__)
+    if (n >= 32) {
+        auto const differs = [&](std::size_t const i) {
+            __m256i const x = ascii_lower32(_mm256_loadu_si256(reinterpret_cast<__m256i const*>(a + i)));
+            __m256i const y = ascii_lower32(_mm256_loadu_si256(reinterpret_cast<__m256i const*>(b + i)));
+            return static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(x, y))) != 0xffffffff;
+        };
+        for (std::size_t i = 0; i + 32 < n; i += 32)
+            if (differs(i))
+                return false;
+        return !differs(n - 32);
+    }
+#endif // __AVX2__
+#if defined(__SSE2__)
+    if (n >= 16) {
+        auto const differs = [&](std::size_t const i) {
+            __m128i const x = ascii_lower16(_mm_loadu_si128(reinterpret_cast<__m128i const*>(a + i)));
+            __m128i const y = ascii_lower16(_mm_loadu_si128(reinterpret_cast<__m128i const*>(b + i)));
+            return _mm_movemask_epi8(_mm_cmpeq_epi8(x, y)) != 0xffff;
+        };
+        for (std::size_t i = 0; i + 16 < n; i += 16)
+            if (differs(i))
+                return false;
+        return !differs(n - 16);
+    }
+#endif // __SSE2__
+    return iequals_swar(a, b, n);
+}
+
+} // namespace detail
+
+// true if a and b are equal ignoring ascii case, other bytes compare exactly
+[[nodiscard]] constexpr bool iequals(std::string_view const a, std::string_view const b) noexcept {
+    if (a.size() != b.size())
+        return false;
+    if (detail::is_constant_evaluated())
+        return detail::iequals_swar(a.data(), b.data(), a.size());
+    return detail::iequals_vectorized(a.data(), b.data(), a.size());
+}
+
+[[nodiscard]] constexpr bool istarts_with(std::string_view const str, std::string_view const prefix) noexcept {
+    return str.size() >= prefix.size() && iequals(str.substr(0, prefix.size()), prefix);
+}
+
+[[nodiscard]] constexpr bool iends_with(std::string_view const str, std::string_view const suffix) noexcept {
+    return str.size() >= suffix.size() && iequals(str.substr(str.size() - suffix.size()), suffix);
+}
+
+// the position of the first occurrence of needle at or after pos ignoring
+// ascii case, npos if there is none, positions whose first and last byte
+// match are found a vector at a time and only those are compared fully
+[[nodiscard]] constexpr std::size_t ifind(std::string_view const haystack, std::string_view const needle, std::size_t pos = 0) noexcept {
+    auto const n = haystack.size();
+    auto const m = needle.size();
+    if (pos > n || m > n - pos)
+        return std::string_view::npos;
+    if (m == 0)
+        return pos;
+    auto const first = detail::ascii_lower(needle.front());
+    auto const last = detail::ascii_lower(needle.back());
+    auto const matches = [&](std::size_t const i) {
+        return iequals(haystack.substr(i + 1, m - 1), needle.substr(1));
+    };
+    if (!detail::is_constant_evaluated()) {
+        auto const scan = [&](std::size_t const width, auto candidates) {
+            for (; pos + m - 1 + width <= n; pos += width)
+                for (auto bits = candidates(haystack.data() + pos, m, first, last); bits != 0; bits &= bits - 1)
+                    if (auto const i = pos + static_cast<std::size_t>(detail::countr_zero(bits)); matches(i))
+                        return i;
+            return std::string_view::npos;
+        };
+#if defined(__AVX2__)
+        if (auto const i = scan(32, &detail::ifind_candidates32); i != std::string_view::npos)
+            return i;
+#endif // __AVX2__
+#if defined(__SSE2__)
+        if (auto const i = scan(16, &detail::ifind_candidates16); i != std::string_view::npos)
+            return i;
+#endif // __SSE2__
+    }
+    for (; pos + m <= n; ++pos)
+        if (detail::ascii_lower(haystack[pos]) == first && matches(pos))
+            return pos;
+    return std::string_view::npos;
+}
+
+// hash_bytes of str with ascii case ignored, consistent with iequals
+[[nodiscard]] constexpr std::uint64_t ihash_bytes(std::string_view const str, std::uint64_t const seed = 0) noexcept {
+    return detail::hash_bytes<true>(str, seed);
+}
+
+// case-insensitive hash and equality for unordered containers keyed by
+// strings, transparent so string views look up std::string keys (C++20)
+// e.g. std::unordered_map<std::string, int, ihash, iequal_to> headers;
+struct ihash {
+    using is_transparent = void;
+
+    [[nodiscard]] std::size_t operator()(std::string_view const str) const noexcept {
+        return static_cast<std::size_t>(ihash_bytes(str));
+    }
+};
+
+struct iequal_to {
+    using is_transparent = void;
+
+    [[nodiscard]] constexpr bool operator()(std::string_view const a, std::string_view const b) const noexcept {
+        return iequals(a, b);
+    }
+};
+
+// string_builder - assembles a string from pieces without reallocating
+// appended views are kept as a rope and copies go to a monotonic arena, the
+// result is written once its length is known, into a single allocation, a
+// caller buffer or (io.hpp) writev, reset is O(1) so a builder can be reused
+// e.g. b.append(method).append(' ').append(path); auto line = b.str();
+class string_builder {
+public:
+    explicit string_builder(std::size_t const block_size = 4 * 1024)
+        : arena_{block_size}
+    {}
+
+    // references str without copying it, it must stay valid until the builder
+    // is reset, a piece that directly follows the previous one extends it
+    string_builder& append(std::string_view const str) {
+        if (str.empty())
+            return *this;
+        if (!pieces_.empty() && pieces_.back().data() + pieces_.back().size() == str.data())
+            pieces_.back() = {pieces_.back().data(), pieces_.back().size() + str.size()};
+        else
+            pieces_.push_back(str);
+        size_ += str.size();
+        return *this;
+    }
+
+    // copies str into the arena, for strings that do not outlive the call
+    string_builder& append_copy(std::string_view const str) {
+        return str.empty() ? *this : append(arena_.store(str));
+    }
+
+    // a temporary std::string dies with the call, so it is copied rather than referenced
+    template<class S, std::enable_if_t<std::is_same_v<S, std::string>, int> = 0>
+    string_builder& append(S&& str) {
+        return append_copy(str);
+    }
+
+    string_builder& append(char const c) {
+        return append_copy(std::string_view{&c, 1});
+    }
+
+    template<class T, std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool> && !std::is_same_v<T, char>, int> = 0>
+    string_builder& append(T const value) {
+        char buffer[std::numeric_limits<T>::digits10 + 2];
+        auto const result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+        return append_copy(std::string_view{buffer, static_cast<std::size_t>(result.ptr - buffer)});
+    }
+
+    // the length of the result
+    [[nodiscard]] std::size_t size() const noexcept { return size_; }
+    [[nodiscard]] bool empty() const noexcept { return size_ == 0; }
+
+    [[nodiscard]] std::vector<std::string_view> const& pieces() const noexcept { return pieces_; }
+
+    // writes the size() chars of the result to the size chars at out, returns
+    // the end of what was written, throws if they do not fit
+    char* copy_to(char* out, std::size_t const size) const {
+        if (size < size_)
+            throw std::length_error{"string_builder: buffer too small"};
+        for (auto const piece : pieces_) {
+            std::memcpy(out, piece.data(), piece.size());
+            out += piece.size();
+        }
+        return out;
+    }
+
+    [[nodiscard]] std::string str() const {
+        std::string ret{};
+        ret.reserve(size_);
+        for (auto const piece : pieces_)
+            ret.append(piece);
+        return ret;
+    }
+
+    // forgets every piece, the arena and piece storage are kept for reuse
+    void reset() noexcept {
+        pieces_.clear();
+        arena_.reset();
+        size_ = 0;
+    }
+
+private:
+    detail::string_arena arena_;
+    std::vector<std::string_view> pieces_;
+    std::size_t size_{};
+};
+
+// a match reported by multi_matcher, offset is the position of its first byte
+struct multi_match {
+    std::size_t pattern{};  // index of the pattern in the set
+    std::size_t offset{};
+    std::size_t length{};
+};
+
+// multi_matcher - finds every occurrence of a fixed set of patterns in one pass
+// the patterns are compiled into an aho-corasick dfa over byte classes, bytes
+// that move every state to the same target share a class so the transition
+// rows stay narrow, when few bytes can start a pattern the scan skips to the
+// next of them with the vectorized delimiter_set search instead of stepping
+// the dfa byte by byte
+// e.g. multi_matcher m{{"he", "she", "hers"}}; m.find_all("ushers") -> she, he, hers
+class multi_matcher {
+public:
+    multi_matcher() = default;
+
+    multi_matcher(std::initializer_list<std::string_view> const patterns)
+        : multi_matcher{patterns.begin(), patterns.end()}
+    {}
+
+    // empty patterns are kept in the set but never match
+    template<class InputIter>
+    multi_matcher(InputIter first, InputIter last) {
+        for (; first != last; ++first)
+            patterns_.emplace_back(std::string_view{*first});
+        build();
+    }
+
+    template<class Range, std::enable_if_t<!std::is_convertible_v<Range const&, std::string_view>, int> = 0>
+    explicit multi_matcher(Range const& patterns)
+        : multi_matcher{std::begin(patterns), std::end(patterns)}
+    {}
+
+    [[nodiscard]] std::size_t size() const noexcept { return patterns_.size(); }
+    [[nodiscard]] bool empty() const noexcept { return patterns_.empty(); }
+    [[nodiscard]] std::string_view pattern(std::size_t const index) const noexcept { return patterns_[index]; }
+
+    // the number of dfa states, a measure of the automaton's size
+    [[nodiscard]] std::size_t state_count() const noexcept { return delta_.size() / stride_; }
+
+    // the number of byte classes, i.e. the width of a transition row
+    [[nodiscard]] std::size_t class_count() const noexcept { return stride_; }
+
+    // calls fn(match) for every occurrence of every pattern in text, overlapping
+    // ones included, in order of their end position
+    template<class Fn>
+    void for_each_match(std::string_view const text, Fn fn) const {
+        scan(text, [&](std::size_t const state, std::size_t const end) {
+            for (auto i = out_offsets_[state]; i != out_offsets_[state + 1]; ++i) {
+                auto const pattern = out_patterns_[i];
+                auto const length = patterns_[pattern].size();
+                fn(multi_match{pattern, end - length, length});
+            }
+            return true;
+        });
+    }
+
+    // calls fn(token, match) for the matches within each token of a range of
+    // string views, such as a strtok_view, offsets are relative to the token
+    template<class Range, class Fn, std::enable_if_t<!std::is_convertible_v<Range const&, std::string_view>, int> = 0>
+    void for_each_match(Range const& tokens, Fn fn) const {
+        for (auto const& token : tokens) {
+            std::string_view const str{token};
+            for_each_match(str, [&](multi_match const& match) { fn(str, match); });
+        }
+    }
+
+    [[nodiscard]] std::vector<multi_match> find_all(std::string_view const text) const {
+        std::vector<multi_match> ret{};
+        for_each_match(text, [&](multi_match const& match) { ret.push_back(match); });
+        return ret;
+    }
+
+    // the match that ends first, stops scanning as soon as it is found
+    [[nodiscard]] std::optional<multi_match> find_first(std::string_view const text) const {
+        std::optional<multi_match> ret{};
+        scan(text, [&](std::size_t const state, std::size_t const end) {
+            // the longest pattern ending here starts first, it comes first in the output list
+            auto const pattern = out_patterns_[out_offsets_[state]];
+            auto const length = patterns_[pattern].size();
+            ret = multi_match{pattern, end - length, length};
+            return false;
+        });
+        return ret;
+    }
+
+    [[nodiscard]] bool contains_any(std::string_view const text) const {
+        return find_first(text).has_value();
+    }
+
+private:
+    using state_type = std::uint32_t;
+
+    // set on a transition whose target state has matches
+    static constexpr state_type match_flag = state_type{1} << 31;
+
+    // steps the dfa over text, calls on_match(state, end) whenever a state with
+    // matches is entered after text[end - 1], stops early if it returns false
+    template<class Fn>
+    void scan(std::string_view const text, Fn on_match) const {
+        if (delta_.empty())
+            return;
+        // transitions hold the row offset of the target state, not its index
+        state_type row{};
+        for (std::size_t i = 0; i < text.size(); ++i) {
+            if (row == 0 && prefilter_) {
+                i = starts_.find_first_of(text, i);
+                if (i == std::string_view::npos)
+                    return;
+            }
+            auto const next = delta_[row + classes_[static_cast<unsigned char>(text[i])]];
+            row = next & ~match_flag;
+            if ((next & match_flag) != 0 && !on_match(row / stride_, i + 1))
+                return;
+        }
+    }
+
+    void build() {
+        // one class per byte used by a pattern, one shared by all the others
+        bool used[256]{};
+        for (auto const& pattern : patterns_)
+            for (char const c : pattern)
+                used[static_cast<unsigned char>(c)] = true;
+        std::size_t classes{};
+        std::optional<std::uint8_t> unused{};
+        for (std::size_t b = 0; b < 256; ++b) {
+            if (used[b])
+                classes_[b] = static_cast<std::uint8_t>(classes++);
+            else {
+                if (!unused)
+                    unused = static_cast<std::uint8_t>(classes++);
+                classes_[b] = *unused;
+            }
+        }
+        stride_ = static_cast<state_type>(classes);
+
+        // the trie, a zero transition is a missing edge since no edge leads to the root
+        delta_.assign(stride_, 0);
+        std::vector<std::vector<state_type>> outputs(1);
+        for (std::size_t index = 0; index < patterns_.size(); ++index) {
+            auto const& pattern = patterns_[index];
+            if (pattern.empty())
+                continue;
+            state_type row{};
+            for (char const c : pattern) {
+                auto const edge = row + classes_[static_cast<unsigned char>(c)];
+                if (delta_[edge] == 0) {
+                    if (delta_.size() + stride_ > match_flag)
+                        throw std::length_error{"multi_matcher: too many states"};
+                    delta_[edge] = static_cast<state_type>(delta_.size());
+                    delta_.resize(delta_.size() + stride_, 0);
+                    outputs.emplace_back();
+                }
+                row = delta_[edge];
+            }
+            outputs[row / stride_].push_back(static_cast<state_type>(index));
+            starts_.insert(pattern.front());
+        }
+
+        // breadth first, so the failure state of every state is complete before it
+        auto const states = delta_.size() / stride_;
+        std::vector<state_type> fail(states);
+        std::vector<state_type> queue{};
+        queue.reserve(states);
+        for (state_type c = 0; c < stride_; ++c)
+            if (auto const child = delta_[c]; child != 0)
+                queue.push_back(child);
+        for (std::size_t head = 0; head < queue.size(); ++head) {
+            auto const row = queue[head];
+            auto const fail_row = fail[row / stride_];
+            // matches of the longest proper suffix follow, so longer patterns come first
+            auto const& suffix = outputs[fail_row / stride_];
+            auto& out = outputs[row / stride_];
+            out.insert(out.end(), suffix.begin(), suffix.end());
+            for (state_type c = 0; c < stride_; ++c) {
+                auto& next = delta_[row + c];
+                if (next != 0) {
+                    fail[next / stride_] = delta_[fail_row + c];
+                    queue.push_back(next);
+                }
+                else
+                    next = delta_[fail_row + c];
+            }
+        }
+
+        merge_classes();
+
+        out_offsets_.assign(states + 1, 0);
+        for (std::size_t state = 0; state < states; ++state) {
+            out_offsets_[state + 1] = out_offsets_[state] + outputs[state].size();
+            out_patterns_.insert(out_patterns_.end(), outputs[state].begin(), outputs[state].end());
+        }
+        for (auto& next : delta_)
+            if (!outputs[next / stride_].empty())
+                next |= match_flag;
+
+        // only worth it when a pattern start is rare, i.e. few bytes can be one
+        std::size_t start_bytes{};
+        for (std::size_t b = 0; b < 256; ++b)
+            start_bytes += starts_.contains(static_cast<char>(b));
+        prefilter_ = start_bytes != 0 && start_bytes <= max_prefilter_bytes;
+    }
+
+    // bytes whose columns are equal in every state of the finished dfa are
+    // interchangeable, they are given one class so each row keeps only
+    // distinct columns, the rows are then repacked at the narrower stride
+    void merge_classes() {
+        std::vector<state_type> order(stride_);
+        for (state_type c = 0; c < stride_; ++c)
+            order[c] = c;
+        auto const column_less = [&](state_type const a, state_type const b) {
+            for (std::size_t row = 0; row < delta_.size(); row += stride_)
+                if (delta_[row + a] != delta_[row + b])
+                    return delta_[row + a] < delta_[row + b];
+            return false;
+        };
+        std::sort(order.begin(), order.end(), column_less);
+
+        std::vector<std::uint8_t> merged(stride_);
+        state_type classes{};
+        for (std::size_t i = 0; i < order.size(); ++i) {
+            if (i != 0 && column_less(order[i - 1], order[i]))
+                ++classes;
+            merged[order[i]] = static_cast<std::uint8_t>(classes);
+        }
+        if (++classes == stride_)
+            return;
+
+        std::vector<state_type> delta(delta_.size() / stride_ * classes);
+        for (std::size_t row = 0, out = 0; row < delta_.size(); row += stride_, out += classes)
+            for (state_type c = 0; c < stride_; ++c)
+                delta[out + merged[c]] = delta_[row + c] / stride_ * classes;
+        for (auto& c : classes_)
+            c = merged[c];
+        delta_ = std::move(delta);
+        stride_ = classes;
+    }
+
+    static constexpr std::size_t max_prefilter_bytes = 8;
+
+    std::vector<std::string> patterns_;
+    std::vector<state_type> delta_;             // stride_ transitions per state
+    std::vector<std::size_t> out_offsets_;      // matches of state s are out_patterns_[out_offsets_[s], out_offsets_[s + 1])
+    std::vector<state_type> out_patterns_;
+    std::uint8_t classes_[256]{};
+    state_type stride_{1};
+    delimiter_set starts_{};                    // the first bytes of the patterns
+    bool prefilter_{};
+};
+
+// C++20 allows allocation and destructors in constant evaluation
+#if defined(__cpp_constexpr_dynamic_alloc) && __cpp_constexpr_dynamic_alloc >= 201907L
+    #define EXTRA_STRING_CONSTEXPR_DYNAMIC constexpr
+#else
+    #define EXTRA_STRING_CONSTEXPR_DYNAMIC
+#endif // __cpp_constexpr_dynamic_alloc
+
+// small_string - a string that stores up to N chars inline, spilling to the
+// heap past that, the inline buffer shares its storage with the heap pointer
+// so sizeof is max(N + 1, 16) plus the size, rounded up to its alignment
+// nothing points into the object itself, so it is trivially relocatable,
+// it is usable in constant expressions from C++20 (C++17 has no constexpr destructors)
+// e.g. std::vector<small_string<23>> tokens; tokens.emplace_back(tok(" "));
+template<std::size_t N>
+class small_string {
+public:
+    using value_type = char;
+    using size_type = std::size_t;
+    using iterator = char*;
+    using const_iterator = char const*;
+
+    static constexpr std::size_t inline_capacity = N;
+
+    constexpr small_string() noexcept = default;
+
+    constexpr explicit small_string(std::string_view const str) {
+        append(str);
+    }
+
+    constexpr small_string(char const* const str)
+        : small_string{std::string_view{str}}
+    {}
+
+    constexpr small_string(std::size_t const count, char const c) {
+        resize(count, c);
+    }
+
+    constexpr small_string(small_string const& other)
+        : small_string{other.view()}
+    {}
+
+    constexpr small_string(small_string&& other) noexcept {
+        steal(other);
+    }
+
+    constexpr small_string& operator=(small_string const& other) {
+        if (this != &other)
+            assign(other.view());
+        return *this;
+    }
+
+    constexpr small_string& operator=(small_string&& other) noexcept {
+        if (this != &other) {
+            release();
+            steal(other);
+        }
+        return *this;
+    }
+
+    constexpr small_string& operator=(std::string_view const str) {
+        return assign(str);
+    }
+
+    constexpr small_string& operator=(char const* const str) {
+        return assign(str);
+    }
+
+    EXTRA_STRING_CONSTEXPR_DYNAMIC ~small_string() { release(); }
+
+    [[nodiscard]] constexpr std::size_t size() const noexcept { return size_ & ~heap_bit; }
+    [[nodiscard]] constexpr std::size_t length() const noexcept { return size(); }
+    [[nodiscard]] constexpr bool empty() const noexcept { return size() == 0; }
+    [[nodiscard]] constexpr std::size_t capacity() const noexcept { return on_heap() ? heap_.capacity : N; }
+
+    // false while the chars are stored inline
+    [[nodiscard]] constexpr bool on_heap() const noexcept { return (size_ & heap_bit) != 0; }
+
+    [[nodiscard]] constexpr char* data() noexcept { return on_heap() ? heap_.data : inline_; }
+    [[nodiscard]] constexpr char const* data() const noexcept { return on_heap() ? heap_.data : inline_; }
+    [[nodiscard]] constexpr char const* c_str() const noexcept { return data(); }
+
+    [[nodiscard]] constexpr std::string_view view() const noexcept { return {data(), size()}; }
+    [[nodiscard]] constexpr operator std::string_view() const noexcept { return view(); }
+
+    [[nodiscard]] constexpr iterator begin() noexcept { return data(); }
+    [[nodiscard]] constexpr iterator end() noexcept { return data() + size(); }
+    [[nodiscard]] constexpr const_iterator begin() const noexcept { return data(); }
+    [[nodiscard]] constexpr const_iterator end() const noexcept { return data() + size(); }
+
+    [[nodiscard]] constexpr char& operator[](std::size_t const i) noexcept { return data()[i]; }
+    [[nodiscard]] constexpr char const& operator[](std::size_t const i) const noexcept { return data()[i]; }
+    [[nodiscard]] constexpr char& front() noexcept { return data()[0]; }
+    [[nodiscard]] constexpr char const& front() const noexcept { return data()[0]; }
+    [[nodiscard]] constexpr char& back() noexcept { return data()[size() - 1]; }
+    [[nodiscard]] constexpr char const& back() const noexcept { return data()[size() - 1]; }
+
+    // str may point into this string
+    constexpr small_string& assign(std::string_view const str) {
+        if (str.size() > capacity())
+            reallocate(str.size(), {}, str);
+        else
+            std::char_traits<char>::move(data(), str.data(), str.size());
+        set_size(str.size());
+        return *this;
+    }
+
+    // str may point into this string
+    constexpr small_string& append(std::string_view const str) {
+        auto const n = size() + str.size();
+        if (n > capacity())
+            reallocate(std::max(n, 2 * capacity()), view(), str);
+        else
+            std::char_traits<char>::move(data() + size(), str.data(), str.size());
+        set_size(n);
+        return *this;
+    }
+
+    constexpr small_string& operator+=(std::string_view const str) { return append(str); }
+    constexpr small_string& operator+=(char const c) { push_back(c); return *this; }
+
+    constexpr void push_back(char const c) {
+        append(std::string_view{&c, 1});
+    }
+
+    constexpr void pop_back() noexcept {
+        set_size(size() - 1);
+    }
+
+    constexpr void resize(std::size_t const count, char const c = '\0') {
+        if (count > capacity())
+            reallocate(count, view(), {});
+        for (auto i = size(); i < count; ++i)
+            data()[i] = c;
+        set_size(count);
+    }
+
+    constexpr void reserve(std::size_t const new_capacity) {
+        if (new_capacity > capacity())
+            reallocate(new_capacity, view(), {});
+    }
+
+    // keeps the heap buffer, if any
+    constexpr void clear() noexcept {
+        set_size(0);
+    }
+
+    // moves the chars back inline if they fit
+    constexpr void shrink_to_fit() noexcept {
+        if (!on_heap() || size() > N)
+            return;
+        auto* const p = heap_.data;
+        auto const n = size();
+        for (std::size_t i = 0; i <= n; ++i)
+            inline_[i] = p[i];
+        delete[] p;
+        size_ = n;
+    }
+
+    constexpr void swap(small_string& other) noexcept {
+        small_string tmp{std::move(other)};
+        other = std::move(*this);
+        *this = std::move(tmp);
+    }
+
+    friend constexpr bool operator==(small_string const& lhs, small_string const& rhs) noexcept {
+        return lhs.view() == rhs.view();
+    }
+
+    friend constexpr bool operator!=(small_string const& lhs, small_string const& rhs) noexcept {
+        return lhs.view() != rhs.view();
+    }
+
+    friend constexpr bool operator<(small_string const& lhs, small_string const& rhs) noexcept {
+        return lhs.view() < rhs.view();
+    }
+
+    // comparisons with string literals, std::string and std::string_view
+    template<class Str, std::enable_if_t<std::is_convertible_v<Str const&, std::string_view> && !std::is_same_v<Str, small_string>, int> = 0>
+    friend constexpr bool operator==(small_string const& lhs, Str const& rhs) noexcept {
+        return lhs.view() == std::string_view{rhs};
+    }
+
+    template<class Str, std::enable_if_t<std::is_convertible_v<Str const&, std::string_view> && !std::is_same_v<Str, small_string>, int> = 0>
+    friend constexpr bool operator==(Str const& lhs, small_string const& rhs) noexcept {
+        return std::string_view{lhs} == rhs.view();
+    }
+
+    template<class Str, std::enable_if_t<std::is_convertible_v<Str const&, std::string_view> && !std::is_same_v<Str, small_string>, int> = 0>
+    friend constexpr bool operator!=(small_string const& lhs, Str const& rhs) noexcept {
+        return !(lhs == rhs);
+    }
+
+    template<class Str, std::enable_if_t<std::is_convertible_v<Str const&, std::string_view> && !std::is_same_v<Str, small_string>, int> = 0>
+    friend constexpr bool operator!=(Str const& lhs, small_string const& rhs) noexcept {
+        return !(lhs == rhs);
+    }
+
+private:
+    static constexpr std::size_t heap_bit = std::size_t{1} << (std::numeric_limits<std::size_t>::digits - 1);
+
+    struct heap_rep {
+        char* data;
+        std::size_t capacity;   // excluding the null terminator
+    };
+
+    // keeps the heap bit and writes the null terminator
+    constexpr void set_size(std::size_t const n) noexcept {
+        size_ = n | (size_ & heap_bit);
+        data()[n] = '\0';
+    }
+
+    // moves to a heap buffer holding head followed by tail, both may
+    // point into the current buffer which is released afterwards
+    constexpr void reallocate(std::size_t const new_capacity, std::string_view const head, std::string_view const tail) {
+        auto* const p = new char[new_capacity + 1];
+        std::char_traits<char>::move(p, head.data(), head.size());
+        std::char_traits<char>::move(p + head.size(), tail.data(), tail.size());
+        release();
+        heap_ = heap_rep{p, new_capacity};
+        size_ = head.size() | heap_bit;
+    }
+
+    // leaves the string empty and inline
+    constexpr void release() noexcept {
+        if (on_heap())
+            delete[] heap_.data;
+        size_ = 0;
+        inline_[0] = '\0';
+    }
+
+    // takes the buffer of other, which is left empty and inline
+    constexpr void steal(small_string& other) noexcept {
+        if (other.on_heap())
+            heap_ = other.heap_;
+        else
+            for (std::size_t i = 0; i <= other.size(); ++i)
+                inline_[i] = other.inline_[i];
+        size_ = other.size_;
+        other.size_ = 0;
+        other.inline_[0] = '\0';
+    }
+
+    union {
+        char inline_[N + 1]{};
+        heap_rep heap_;
+    };
+    std::size_t size_{};        // the top bit is set while the chars are on the heap
+};
+
+template<std::size_t N>
+struct is_trivially_relocatable<small_string<N>> : std::true_type {};
+
+} // namespace extra
+
+namespace std {
+
+template<std::size_t N>
+struct hash<extra::small_string<N>> {
+    std::size_t operator()(extra::small_string<N> const& str) const noexcept {
+        return std::hash<std::string_view>{}(str.view());
+    }
+};
+
+} // namespace std
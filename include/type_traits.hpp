@@ -7,6 +7,30 @@
 
 namespace extra {
 
+namespace detail {
+
+// true when called during constant evaluation, used to keep the
+// vectorized paths out of constexpr contexts, where it cannot be told it
+// is false, so runtime calls never take the slower constant evaluation
+// paths and constant evaluation of a vectorized path fails to compile
+constexpr bool is_constant_evaluated() noexcept {
+#if defined(__cpp_lib_is_constant_evaluated)
+    return std::is_constant_evaluated();
+#elif defined(__has_builtin)
+    #if __has_builtin(__builtin_is_constant_evaluated)
+        return __builtin_is_constant_evaluated();
+    #else
+        return false;
+    #endif
+#elif defined(_MSC_VER) && _MSC_VER >= 1925
+    return __builtin_is_constant_evaluated();
+#else
+    return false;
+#endif
+}
+
+} // namespace detail
+
 // C++20's remove_cvref - removes both cv and ref qualifiers
 template<class T>
 struct remove_cvref {
@@ -83,6 +107,14 @@ struct has_type : std::disjunction<std::is_same<T, Us>...> {};
 template<class T, class... Us>
 inline static constexpr bool has_type_v = has_type<T, Us...>::value;
 
+// is_trivially_relocatable - checks if moving a T and destroying the source
+// can be replaced by a memcpy, types opt in by specializing it
+template<class T>
+struct is_trivially_relocatable : std::is_trivially_copyable<T> {};
+
+template<class T>
+inline constexpr bool is_trivially_relocatable_v = is_trivially_relocatable<T>::value;
+
 // always_false - template class for always false static asserts
 template<class... Ts>
 struct always_false : std::false_type {};
@@ -0,0 +1,391 @@
+// unordered_map.hpp
+
+#pragma once
+
+#include "string.hpp"
+#include "type_traits.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <tuple>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#if defined(__SSE2__)
+    #include <emmintrin.h>
+#endif // __SSE2__
+
+namespace extra {
+
+namespace detail {
+
+// control byte states, a full slot stores the low 7 bits of its hash
+inline constexpr std::int8_t ctrl_empty = -128;
+inline constexpr std::int8_t ctrl_deleted = -2;
+
+inline constexpr std::size_t ctrl_group_width = 16;
+
+// ctrl_group - 16 control bytes compared against a value at once
+class ctrl_group {
+public:
+    explicit ctrl_group(std::int8_t const* const ctrl) noexcept {
+#if defined(__SSE2__)
+        ctrl_ = _mm_loadu_si128(reinterpret_cast<__m128i const*>(ctrl));
+#else
+        std::memcpy(ctrl_, ctrl, ctrl_group_width);
+#endif // __SSE2__
+    }
+
+    // bit i is set iff ctrl[i] == h2
+    [[nodiscard]] std::uint32_t match(std::int8_t const h2) const noexcept {
+#if defined(__SSE2__)
+        return static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl_, _mm_set1_epi8(h2))));
+#else
+        std::uint32_t m{};
+        for (std::size_t i = 0; i < ctrl_group_width; ++i)
+            m |= static_cast<std::uint32_t>(ctrl_[i] == h2) << i;
+        return m;
+#endif // __SSE2__
+    }
+
+    [[nodiscard]] std::uint32_t match_empty() const noexcept { return match(ctrl_empty); }
+
+    // empty and deleted are the only states with the sign bit set
+    [[nodiscard]] std::uint32_t match_empty_or_deleted() const noexcept {
+#if defined(__SSE2__)
+        return static_cast<std::uint32_t>(_mm_movemask_epi8(ctrl_));
+#else
+        std::uint32_t m{};
+        for (std::size_t i = 0; i < ctrl_group_width; ++i)
+            m |= static_cast<std::uint32_t>(ctrl_[i] < 0) << i;
+        return m;
+#endif // __SSE2__
+    }
+
+private:
+#if defined(__SSE2__)
+    __m128i ctrl_;
+#else
+    std::int8_t ctrl_[ctrl_group_width];
+#endif // __SSE2__
+};
+
+} // namespace detail
+
+// string_map - an open addressing hash map from strings to V
+// slots are probed 16 at a time through a parallel array of control bytes
+// holding 7 bits of each hash (swiss table), key bytes are copied into an
+// arena so lookups take a string_view and never construct a std::string,
+// the bytes of erased keys are only released by clear()
+template<class V>
+class string_map {
+public:
+    using key_type = std::string_view;
+    using mapped_type = V;
+    using value_type = std::pair<std::string_view const, V>;
+    using size_type = std::size_t;
+
+    template<bool Const>
+    class basic_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = typename string_map::value_type;
+        using difference_type = std::ptrdiff_t;
+        using pointer = std::conditional_t<Const, value_type const*, value_type*>;
+        using reference = std::conditional_t<Const, value_type const&, value_type&>;
+
+        basic_iterator() noexcept = default;
+
+        template<bool C = Const, std::enable_if_t<C, int> = 0>
+        basic_iterator(basic_iterator<false> const& other) noexcept
+            : ctrl_{other.ctrl_}
+            , last_{other.last_}
+            , slot_{other.slot_}
+        {}
+
+        [[nodiscard]] reference operator*() const noexcept { return *slot_; }
+        [[nodiscard]] pointer operator->() const noexcept { return slot_; }
+
+        basic_iterator& operator++() noexcept {
+            ++ctrl_;
+            ++slot_;
+            skip_free();
+            return *this;
+        }
+
+        basic_iterator operator++(int) noexcept {
+            auto saved{*this};
+            ++*this;
+            return saved;
+        }
+
+        friend bool operator==(basic_iterator const& lhs, basic_iterator const& rhs) noexcept {
+            return lhs.ctrl_ == rhs.ctrl_;
+        }
+
+        friend bool operator!=(basic_iterator const& lhs, basic_iterator const& rhs) noexcept {
+            return !(lhs == rhs);
+        }
+
+    private:
+        friend class string_map;
+        friend class basic_iterator<!Const>;
+
+        basic_iterator(std::int8_t const* const ctrl, std::int8_t const* const last, pointer const slot) noexcept
+            : ctrl_{ctrl}
+            , last_{last}
+            , slot_{slot}
+        {}
+
+        void skip_free() noexcept {
+            for (; ctrl_ != last_ && *ctrl_ < 0; ++ctrl_)
+                ++slot_;
+        }
+
+        std::int8_t const* ctrl_{};
+        std::int8_t const* last_{};
+        pointer slot_{};
+    };
+
+    using iterator = basic_iterator<false>;
+    using const_iterator = basic_iterator<true>;
+
+    string_map() noexcept = default;
+
+    string_map(string_map const& other)
+        : string_map()
+    {
+        reserve(other.size());
+        for (auto const& [key, value] : other)
+            try_emplace(key, value);
+    }
+
+    string_map(string_map&& other) noexcept
+        : ctrl_{std::exchange(other.ctrl_, nullptr)}
+        , slots_{std::exchange(other.slots_, nullptr)}
+        , capacity_{std::exchange(other.capacity_, 0)}
+        , size_{std::exchange(other.size_, 0)}
+        , growth_left_{std::exchange(other.growth_left_, 0)}
+        , arena_{std::move(other.arena_)}
+    {}
+
+    string_map& operator=(string_map other) noexcept {
+        swap(other);
+        return *this;
+    }
+
+    ~string_map() { release(); }
+
+    void swap(string_map& other) noexcept {
+        std::swap(ctrl_, other.ctrl_);
+        std::swap(slots_, other.slots_);
+        std::swap(capacity_, other.capacity_);
+        std::swap(size_, other.size_);
+        std::swap(growth_left_, other.growth_left_);
+        std::swap(arena_, other.arena_);
+    }
+
+    [[nodiscard]] iterator begin() noexcept { return make_iterator(0); }
+    [[nodiscard]] iterator end() noexcept { return {ctrl_ + capacity_, ctrl_ + capacity_, slots_ + capacity_}; }
+    [[nodiscard]] const_iterator begin() const noexcept { return const_cast<string_map&>(*this).begin(); }
+    [[nodiscard]] const_iterator end() const noexcept { return const_cast<string_map&>(*this).end(); }
+
+    [[nodiscard]] size_type size() const noexcept { return size_; }
+    [[nodiscard]] bool empty() const noexcept { return size_ == 0; }
+    [[nodiscard]] size_type capacity() const noexcept { return capacity_; }
+
+    template<class... Args>
+    std::pair<iterator, bool> try_emplace(std::string_view const key, Args&&... args) {
+        auto const hash = detail::hash_bytes(key);
+        if (auto const i = find_index(key, hash); i != capacity_)
+            return {make_iterator(i), false};
+
+        if (capacity_ == 0)
+            rehash(detail::ctrl_group_width);
+        auto i = find_free(hash);
+        if (growth_left_ == 0 && ctrl_[i] == detail::ctrl_empty) {
+            // drop tombstones in place when they, not live keys, filled the table
+            rehash(2 * size_ < max_load(capacity_) ? capacity_ : 2 * capacity_);
+            i = find_free(hash);
+        }
+        ::new (static_cast<void*>(slots_ + i)) value_type(std::piecewise_construct,
+            std::forward_as_tuple(arena_.store(key)), std::forward_as_tuple(std::forward<Args>(args)...));
+        growth_left_ -= ctrl_[i] == detail::ctrl_empty;
+        ctrl_[i] = h2(hash);
+        ++size_;
+        return {make_iterator(i), true};
+    }
+
+    V& operator[](std::string_view const key) {
+        return try_emplace(key).first->second;
+    }
+
+    [[nodiscard]] V& at(std::string_view const key) {
+        if (auto const i = find_index(key, detail::hash_bytes(key)); i != capacity_)
+            return slots_[i].second;
+        throw std::out_of_range{"extra::string_map::at"};
+    }
+
+    [[nodiscard]] V const& at(std::string_view const key) const {
+        return const_cast<string_map&>(*this).at(key);
+    }
+
+    [[nodiscard]] iterator find(std::string_view const key) noexcept {
+        auto const i = find_index(key, detail::hash_bytes(key));
+        return i == capacity_ ? end() : make_iterator(i);
+    }
+
+    [[nodiscard]] const_iterator find(std::string_view const key) const noexcept {
+        return const_cast<string_map&>(*this).find(key);
+    }
+
+    [[nodiscard]] bool contains(std::string_view const key) const noexcept {
+        return find_index(key, detail::hash_bytes(key)) != capacity_;
+    }
+
+    size_type erase(std::string_view const key) noexcept {
+        auto const i = find_index(key, detail::hash_bytes(key));
+        if (i == capacity_)
+            return 0;
+        slots_[i].~value_type();
+        // a slot whose group was never full can't be on another key's probe sequence
+        auto const group = i & ~(detail::ctrl_group_width - 1);
+        if (detail::ctrl_group{ctrl_ + group}.match_empty() != 0) {
+            ctrl_[i] = detail::ctrl_empty;
+            ++growth_left_;
+        }
+        else
+            ctrl_[i] = detail::ctrl_deleted;
+        --size_;
+        return 1;
+    }
+
+    void clear() noexcept {
+        destroy_slots();
+        if (capacity_ != 0)
+            std::memset(ctrl_, static_cast<unsigned char>(detail::ctrl_empty), capacity_);
+        size_ = 0;
+        growth_left_ = max_load(capacity_);
+        arena_.clear();
+    }
+
+    void reserve(size_type const count) {
+        auto capacity = capacity_ == 0 ? detail::ctrl_group_width : capacity_;
+        while (max_load(capacity) < count)
+            capacity *= 2;
+        if (capacity != capacity_)
+            rehash(capacity);
+    }
+
+private:
+    // keep the load factor at or below 7/8
+    static constexpr size_type max_load(size_type const capacity) noexcept {
+        return capacity - capacity / 8;
+    }
+
+    static constexpr std::int8_t h2(std::uint64_t const hash) noexcept {
+        return static_cast<std::int8_t>(hash & 0x7f);
+    }
+
+    iterator make_iterator(size_type const i) noexcept {
+        iterator it{ctrl_ + i, ctrl_ + capacity_, slots_ + i};
+        it.skip_free();
+        return it;
+    }
+
+    // groups are visited in triangular order, which covers
+    // every group of a power of two table
+    size_type find_index(std::string_view const key, std::uint64_t const hash) const noexcept {
+        if (capacity_ == 0)
+            return capacity_;
+        auto const groups = capacity_ / detail::ctrl_group_width;
+        auto g = static_cast<size_type>(hash >> 7) & (groups - 1);
+        for (size_type step = 1; step <= groups; g = (g + step++) & (groups - 1)) {
+            auto const base = g * detail::ctrl_group_width;
+            detail::ctrl_group const group{ctrl_ + base};
+            for (auto m = group.match(h2(hash)); m != 0; m &= m - 1) {
+                auto const i = base + static_cast<size_type>(detail::countr_zero(m));
+                if (slots_[i].first == key)
+                    return i;
+            }
+            // an empty slot ends the probe sequence
+            if (group.match_empty() != 0)
+                break;
+        }
+        return capacity_;
+    }
+
+    size_type find_free(std::uint64_t const hash) const noexcept {
+        auto const groups = capacity_ / detail::ctrl_group_width;
+        auto g = static_cast<size_type>(hash >> 7) & (groups - 1);
+        for (size_type step = 1;; g = (g + step++) & (groups - 1)) {
+            auto const base = g * detail::ctrl_group_width;
+            if (auto const m = detail::ctrl_group{ctrl_ + base}.match_empty_or_deleted(); m != 0)
+                return base + static_cast<size_type>(detail::countr_zero(m));
+        }
+    }
+
+    void rehash(size_type const capacity) {
+        auto const old_ctrl = ctrl_;
+        auto const old_slots = slots_;
+        auto const old_capacity = capacity_;
+
+        auto ctrl = std::make_unique<std::int8_t[]>(capacity);
+        slots_ = std::allocator<value_type>{}.allocate(capacity);
+        ctrl_ = ctrl.release();
+        std::memset(ctrl_, static_cast<unsigned char>(detail::ctrl_empty), capacity);
+        capacity_ = capacity;
+        growth_left_ = max_load(capacity) - size_;
+
+        for (size_type i = 0; i < old_capacity; ++i) {
+            if (old_ctrl[i] < 0)
+                continue;
+            auto& slot = old_slots[i];
+            auto const hash = detail::hash_bytes(slot.first);
+            auto const j = find_free(hash);
+            // the key is a string_view, so the slot relocates whenever the value does
+            if constexpr (is_trivially_relocatable_v<V>)
+                std::memcpy(static_cast<void*>(slots_ + j), static_cast<void const*>(&slot), sizeof(value_type));
+            else {
+                ::new (static_cast<void*>(slots_ + j)) value_type(slot.first, std::move(slot.second));
+                slot.~value_type();
+            }
+            ctrl_[j] = h2(hash);
+        }
+        if (old_capacity != 0) {
+            std::allocator<value_type>{}.deallocate(old_slots, old_capacity);
+            delete[] old_ctrl;
+        }
+    }
+
+    void destroy_slots() noexcept {
+        if constexpr (!std::is_trivially_destructible_v<value_type>) {
+            for (size_type i = 0; i < capacity_; ++i)
+                if (ctrl_[i] >= 0)
+                    slots_[i].~value_type();
+        }
+    }
+
+    void release() noexcept {
+        if (capacity_ == 0)
+            return;
+        destroy_slots();
+        std::allocator<value_type>{}.deallocate(slots_, capacity_);
+        delete[] ctrl_;
+    }
+
+    std::int8_t* ctrl_{};
+    value_type* slots_{};
+    size_type capacity_{};
+    size_type size_{};
+    size_type growth_left_{};
+    detail::string_arena arena_{};
+};
+
+} // namespace extra
@@ -3,16 +3,300 @@
 #include "catch.hpp"
 #include "../include/algorithm.hpp"
 
-#include <vector>
+#include <atomic>
+#include <execution>
+#include <functional>
+#include <iterator>
 #include <list>
+#include <numeric>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if __has_include(<tbb/global_control.h>)
+    #include <tbb/global_control.h>
+#endif
 
 template<class T>
 void test() {
     T t = {1, 2, 3, 5, 6, 7, 8, 9};
-    REQUIRE(extra::min_unused(t.begin(), t.end()) == 4);
+    REQUIRE(extra::min_unused(t.begin(), t.end(), 1) == 4);
 }
 
 TEST_CASE("min_unused", "[algorithm]") {
     test<std::vector<int>>();
     test<std::list<int>>();
-}
\ No newline at end of file
+
+    // an integral value over non-integral elements takes the generic overloads
+    std::vector<double> mixed = {0.0, 1.0, 3.0};
+    REQUIRE(extra::min_unused(mixed.begin(), mixed.end(), 0) == 2);
+    REQUIRE(extra::min_unused(std::execution::par, mixed.begin(), mixed.end(), 0) == 2);
+}
+TEST_CASE("min_unused integral", "[algorithm]") {
+    std::vector<int> ids(1 << 20);
+    for (std::size_t i = 0; i < ids.size(); ++i)
+        ids[i] = static_cast<int>((i * 7919) % ids.size());
+    ids[12345] = -1;
+    auto const copy = ids;
+    REQUIRE(extra::min_unused(ids.begin(), ids.end()) == static_cast<int>((12345 * 7919) % ids.size()));
+    REQUIRE(ids == copy);
+
+    // duplicates, values below the start and a sparse span
+    std::vector<long> const sparse = {5, 5, 3, 1'000'000'000'000, -7, 4, 7};
+    REQUIRE(extra::min_unused(sparse.begin(), sparse.end(), 3L) == 6);
+    REQUIRE(extra::min_unused(sparse.begin(), sparse.end(), -7L) == -6);
+    REQUIRE(extra::min_unused(sparse.begin(), sparse.end()) == 0);
+
+    unsigned const full[] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19};
+    REQUIRE(extra::min_unused(std::begin(full), std::end(full)) == 20u);
+    REQUIRE(extra::min_unused(full, full) == 0u);
+
+    // usable in constant expressions
+    constexpr int ids_in_use[] = {0, 1, 2, 4, -3, 2};
+    static_assert(extra::min_unused(std::begin(ids_in_use), std::end(ids_in_use)) == 3);
+    static_assert(extra::min_unused(std::begin(ids_in_use), std::end(ids_in_use), -3) == -2);
+}
+TEST_CASE("min_unused parallel", "[algorithm]") {
+    // enough values for a chunk per thread, the gap sits in a late block
+    std::vector<std::int64_t> ids(1 << 21);
+    for (std::size_t i = 0; i < ids.size(); ++i)
+        ids[i] = static_cast<std::int64_t>((i * 7919) % ids.size());
+    auto const gap = static_cast<std::int64_t>((std::size_t{1'900'000} * 7919) % ids.size());
+    ids[1'900'000] = -5;
+    REQUIRE(extra::min_unused(std::execution::par, ids.begin(), ids.end()) == gap);
+    REQUIRE(extra::min_unused(std::execution::par, ids.begin(), ids.end(), std::int64_t{-5}) == -4);
+    REQUIRE(extra::min_unused(std::execution::par, ids.begin(), ids.end(), gap + 1) == static_cast<std::int64_t>(ids.size()));
+
+    std::list<std::int64_t> const list(ids.begin(), ids.end());
+    REQUIRE(extra::min_unused(std::execution::par, list.begin(), list.end()) == gap);
+    REQUIRE(extra::min_unused(std::execution::seq, ids.begin(), ids.begin() + 10) == extra::min_unused(ids.begin(), ids.begin() + 10));
+
+    // sequenced policies never pay for the atomic bitmap
+    REQUIRE(extra::min_unused(std::execution::seq, ids.begin(), ids.end()) == gap);
+    static_assert(extra::detail::is_sequenced_policy_v<std::execution::sequenced_policy const&>);
+    static_assert(!extra::detail::is_sequenced_policy_v<std::execution::parallel_policy const&>);
+}
+template<class T>
+void test_adjacent_kernels() {
+    for (std::size_t const n : {0, 1, 2, 3, 17, 64, 100, 1000, 100000}) {
+        std::vector<T> v(n);
+        unsigned seed = static_cast<unsigned>(n);
+        for (auto& x : v)
+            x = static_cast<T>((seed = seed * 1103515245 + 12345) >> 28);
+
+        std::vector<T> deltas(n), expected(n);
+        REQUIRE(extra::adjacent_difference(v.data(), v.data() + n, deltas.data()) == deltas.data() + std::max<std::size_t>(n, 1) - 1);
+        if (n > 1)
+            std::adjacent_difference(v.begin(), v.end(), expected.begin());
+        REQUIRE(std::equal(deltas.begin(), deltas.begin() + std::max<std::size_t>(n, 1) - 1, expected.begin() + 1));
+
+        std::size_t runs = !v.empty();
+        extra::adjacent_pair(v.begin(), v.end(), [&](T a, T b) { runs += a != b; });
+        REQUIRE(extra::count_runs(v.data(), v.data() + n) == runs);
+
+        REQUIRE(extra::is_sorted(v.data(), v.data() + n) == std::is_sorted(v.begin(), v.end()));
+        std::sort(v.begin(), v.end());
+        REQUIRE(extra::is_sorted(v.data(), v.data() + n));
+        if (n > 2) {
+            std::swap(v[n - 2], v.back());
+            REQUIRE(extra::is_sorted(v.data(), v.data() + n) == (v[n - 2] == v.back()));
+        }
+
+        // in place
+        auto in_place = v;
+        extra::adjacent_difference(in_place.data(), in_place.data() + n, in_place.data());
+        extra::adjacent_difference(v.data(), v.data() + n, deltas.data());
+        REQUIRE(std::equal(deltas.begin(), deltas.begin() + std::max<std::size_t>(n, 1) - 1, in_place.begin()));
+    }
+}
+TEST_CASE("adjacent_batches", "[algorithm]") {
+    test_adjacent_kernels<double>();
+    test_adjacent_kernels<float>();
+    test_adjacent_kernels<std::int64_t>();
+    test_adjacent_kernels<int>();
+    test_adjacent_kernels<std::uint16_t>();
+    test_adjacent_kernels<unsigned char>();
+
+    // narrow lanes are summed before they wrap
+    std::vector<std::uint8_t> alternating(100000);
+    for (std::size_t i = 0; i < alternating.size(); ++i)
+        alternating[i] = i % 2;
+    REQUIRE(extra::count_runs(alternating.data(), alternating.data() + alternating.size()) == alternating.size());
+
+    // every pair is handed out once and in order, the last batch may be short
+    std::vector<int> v(1000);
+    std::iota(v.begin(), v.end(), 0);
+    int next = 0;
+    extra::adjacent_batches(v.data(), v.data() + v.size(), [&](int const* a, int const* b, std::size_t n) {
+        for (std::size_t j = 0; j < n; ++j, ++next)
+            REQUIRE((a[j] == next && b[j] == next + 1));
+    });
+    REQUIRE(next == 999);
+
+    long sum{};
+    extra::adjacent_batches(v.data(), v.data() + v.size(), extra::pairwise([&](int a, int b) { sum += a * b; }));
+    long expected{};
+    extra::adjacent_pair(v.begin(), v.end(), [&](int a, int b) { expected += a * b; });
+    REQUIRE(sum == expected);
+
+    // returning false stops after the batch
+    std::size_t batches{};
+    extra::adjacent_batches(v.data(), v.data() + v.size(), [&](int const*, int const*, std::size_t) { return ++batches < 2; });
+    REQUIRE(batches == 2);
+    extra::adjacent_batches(v.data(), v.data() + 1, [&](int const*, int const*, std::size_t) { ++batches; });
+    REQUIRE(batches == 2);
+}
+TEST_CASE("adjacent_pair parallel", "[algorithm]") {
+    for (std::size_t const n : {0, 1, 2, 1000, 1'000'000}) {
+        std::vector<long> v(n);
+        std::iota(v.begin(), v.end(), 0);
+
+        // every pair exactly once
+        std::vector<std::atomic<int>> visits(n);
+        std::atomic<int> errors{};
+        extra::adjacent_pair(std::execution::par, v.begin(), v.end(), [&](long const& a, long const& b) {
+            errors += &b != &a + 1;
+            ++visits[static_cast<std::size_t>(a)];
+        });
+        REQUIRE(errors == 0);
+        REQUIRE(std::all_of(visits.begin(), visits.end(), [&](auto const& x) { return x == (&x != &visits.back()); }));
+
+        auto const sum = extra::adjacent_pair_reduce(std::execution::par, v.begin(), v.end(), 0L,
+            [](long a, long b) { return b - a; }, std::plus<>{});
+        REQUIRE(sum == std::max<long>(static_cast<long>(n) - 1, 0));
+
+        // chunks are combined in order, concatenation is not commutative
+        auto const digits = extra::adjacent_pair_reduce(std::execution::par, v.begin(), v.end(), std::string{"^"},
+            [](long a, long) { return std::string(1, static_cast<char>('0' + a % 10)); },
+            [](std::string acc, std::string const& s) {
+                acc += s;
+                return acc;
+            });
+        std::string expected{"^"};
+        for (std::size_t i = 0; i + 1 < n; ++i)
+            expected += static_cast<char>('0' + i % 10);
+        REQUIRE(digits == expected);
+    }
+}
+TEST_CASE("min_unused benchmark", "[.][benchmark][algorithm]") {
+    std::vector<std::int64_t> ids(100'000'000);
+    for (std::size_t i = 0; i < ids.size(); ++i)
+        ids[i] = static_cast<std::int64_t>((i * 7919) % ids.size());
+    ids[ids.size() / 2] = -1;
+    auto const gap = static_cast<std::int64_t>((ids.size() / 2 * 7919) % ids.size());
+    std::int64_t result{};
+
+    BENCHMARK("min_unused") {
+        result = extra::min_unused(ids.begin(), ids.end());
+    }
+    REQUIRE(result == gap);
+
+    BENCHMARK("min_unused(seq)") {
+        result = extra::min_unused(std::execution::seq, ids.begin(), ids.end());
+    }
+    REQUIRE(result == gap);
+
+    // the same work on 1, 2, 4 ... up to every core
+    auto const cores = std::max(std::thread::hardware_concurrency(), 1u);
+    for (unsigned threads = 1;; threads = std::min(threads * 2, cores)) {
+#if __has_include(<tbb/global_control.h>)
+        tbb::global_control const limit{tbb::global_control::max_allowed_parallelism, threads};
+#endif
+        BENCHMARK("min_unused(par) on " + std::to_string(threads) + " threads") {
+            result = extra::min_unused(std::execution::par, ids.begin(), ids.end());
+        }
+        REQUIRE(result == gap);
+        if (threads == cores)
+            break;
+    }
+}
+TEST_CASE("id_allocator", "[algorithm]") {
+    // one, two and three levels, with and without a partial last word
+    for (std::size_t const capacity : {0, 1, 64, 100, 4096, 64 * 64 + 5}) {
+        extra::id_allocator<int> ids{capacity};
+        for (std::size_t i = 0; i < capacity; ++i)
+            REQUIRE(ids.acquire() == static_cast<int>(i));
+        REQUIRE(ids.full());
+        REQUIRE(!ids.acquire());
+        REQUIRE(ids.size() == capacity);
+        REQUIRE(!ids.release(static_cast<int>(capacity)));
+    }
+
+    // the largest id must fit in T
+    REQUIRE(extra::id_allocator<std::uint16_t>{65536}.capacity() == 65536);
+    REQUIRE_THROWS_AS(extra::id_allocator<std::uint16_t>{65537}, std::length_error);
+    REQUIRE_THROWS_AS(extra::concurrent_id_allocator<std::int8_t>{129}, std::length_error);
+
+    // random acquire and release against a set of the free values
+    extra::id_allocator<unsigned> ids{64 * 64 + 5};
+    std::set<unsigned> unused;
+    for (unsigned i = 0; i < ids.capacity(); ++i)
+        unused.insert(i);
+    unsigned seed = 42;
+    for (int i = 0; i < 20000; ++i) {
+        seed = seed * 1103515245 + 12345;
+        if (auto const v = (seed >> 8) % ids.capacity(); seed & 0x10000) {
+            REQUIRE(ids.release(v) == (unused.count(v) == 0));
+            unused.insert(v);
+        }
+        else if (!unused.empty()) {
+            REQUIRE(ids.acquire() == *unused.begin());
+            unused.erase(unused.begin());
+        }
+        REQUIRE(ids.size() == ids.capacity() - unused.size());
+    }
+    for (unsigned i = 0; i < ids.capacity(); ++i)
+        REQUIRE(ids.in_use(i) == (unused.count(i) == 0));
+}
+TEST_CASE("concurrent_id_allocator", "[algorithm]") {
+    // all but the last few values are taken so words fill up and empty all the time
+    extra::concurrent_id_allocator<> ids{64 * 64 * 2 + 7};
+    // a full allocator hands a released id straight back
+    while (ids.acquire()) {}
+    REQUIRE(ids.release(4242));
+    REQUIRE(ids.acquire() == std::size_t{4242});
+    REQUIRE(!ids.acquire());
+    for (std::size_t i = 0; i < ids.capacity(); ++i)
+        ids.release(i);
+
+    auto const taken = ids.capacity() - 100;
+    for (std::size_t i = 0; i < taken; ++i)
+        REQUIRE(ids.acquire() == i);
+
+    std::vector<std::atomic<int>> owners(ids.capacity());
+    std::atomic<int> errors{};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t)
+        threads.emplace_back([&] {
+            std::vector<std::size_t> held;
+            for (int round = 0; round < 5000; ++round) {
+                for (auto const v : held) {
+                    owners[v].fetch_sub(1);
+                    errors += !ids.release(v);
+                }
+                held.clear();
+                for (int i = 0; i < 32; ++i)
+                    if (auto const v = ids.acquire()) {
+                        // no value is handed out twice
+                        errors += *v < taken || owners[*v].fetch_add(1) != 0;
+                        held.push_back(*v);
+                    }
+            }
+            for (auto const v : held) {
+                owners[v].fetch_sub(1);
+                errors += !ids.release(v);
+            }
+        });
+    for (auto& t : threads)
+        t.join();
+    REQUIRE(errors == 0);
+
+    // once quiet every summary is consistent again
+    REQUIRE(ids.size() == taken);
+    for (std::size_t i = taken; i < ids.capacity(); ++i)
+        REQUIRE(ids.acquire() == i);
+    REQUIRE(!ids.acquire());
+    REQUIRE(ids.release(7));
+    REQUIRE(ids.acquire() == 7u);
+}
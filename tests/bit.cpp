@@ -3,9 +3,21 @@
 #include "catch.hpp"
 #include "../include/bit.hpp"
 
+#include <cstdint>
+
 TEST_CASE("bit_cast", "[bit]") {
     int const i = 0xabcdef;
     float const f = extra::bit_cast<float>(i);
     int const res = extra::bit_cast<int>(f);
     REQUIRE(i == res);
-}
\ No newline at end of file
+}
+TEST_CASE("countr_zero", "[bit]") {
+    static_assert(extra::countr_zero(0u) == 32);
+    static_assert(extra::countr_zero(std::uint8_t{0x10}) == 4);
+    static_assert(extra::countr_one(std::uint8_t{0xff}) == 8);
+    static_assert(extra::countr_one(0x7ull) == 3);
+    for (int i = 0; i < 64; ++i) {
+        REQUIRE(extra::countr_zero(std::uint64_t{1} << i) == i);
+        REQUIRE(extra::countr_one((std::uint64_t{1} << i) - 1) == i);
+    }
+}
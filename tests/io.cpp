@@ -0,0 +1,67 @@
+// io.cpp
+
+#include "catch.hpp"
+#include "../include/io.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace std::string_view_literals;
+
+TEST_CASE("mapped_file", "[io]") {
+    auto const path = std::filesystem::temp_directory_path() / "extra_io_mapped_file.txt";
+    {
+        std::ofstream out{path, std::ios::binary};
+        out << "GET /index.html 200\nPOST /login 302\n";
+    }
+
+    extra::mapped_file const file{path};
+    REQUIRE(file.view() == "GET /index.html 200\nPOST /login 302\n"sv);
+
+    std::vector<std::string> lines{};
+    for (auto const line : extra::tokenize_file(path, "\n"))
+        lines.emplace_back(line);
+    REQUIRE(lines == std::vector<std::string>{"GET /index.html 200", "POST /login 302"});
+
+    auto const tokens = extra::tokenize_file(path, " \n");
+    REQUIRE(tokens.count() == 6);
+    REQUIRE(*std::next(tokens.begin(), 4) == "/login"sv);
+
+    auto moved = extra::mapped_file{path};
+    extra::mapped_file other{std::move(moved)};
+    REQUIRE(moved.empty());
+    REQUIRE(other.size() == file.size());
+
+    {
+        std::ofstream out{path, std::ios::binary | std::ios::trunc};
+    }
+    REQUIRE(extra::mapped_file{path}.view().empty());
+    REQUIRE(extra::tokenize_file(path, " ").count() == 0);
+
+    std::filesystem::remove(path);
+    REQUIRE_THROWS_AS(extra::mapped_file{path}, std::system_error);
+}
+
+TEST_CASE("write_all", "[io]") {
+    auto const path = std::filesystem::temp_directory_path() / "extra_io_write_all.txt";
+    int const fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+    REQUIRE(fd != -1);
+
+    // more pieces than one writev call takes
+    std::string const words{"alpha beta gamma "};
+    extra::string_builder builder{};
+    std::string expected{};
+    for (std::size_t i = 0; i < 3000; ++i) {
+        builder.append(std::string_view{words}.substr(i % 3 * 6, 5)).append(i);
+        expected.append(words, i % 3 * 6, 5).append(std::to_string(i));
+    }
+    REQUIRE(builder.pieces().size() > IOV_MAX);
+    extra::write_all(fd, builder);
+    ::close(fd);
+    REQUIRE(extra::mapped_file{path}.view() == expected);
+
+    std::filesystem::remove(path);
+    REQUIRE_THROWS_AS(extra::write_all(-1, builder), std::system_error);
+}
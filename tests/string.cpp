@@ -0,0 +1,735 @@
+// string.cpp
+
+#include "catch.hpp"
+#include "../include/string.hpp"
+#include "../include/iterator.hpp"
+
+#include <cctype>
+#include <execution>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace std::string_view_literals;
+
+namespace {
+
+// reference implementation of strtok_all built on std::string_view
+std::vector<std::string_view> reference_strtok_all(std::string_view const str, std::string_view const tokens) {
+    std::vector<std::string_view> ret{};
+    auto begin = str.find_first_not_of(tokens);
+    while (begin != std::string_view::npos) {
+        auto const end = str.find_first_of(tokens, begin);
+        ret.push_back(str.substr(begin, end == std::string_view::npos ? end : end - begin));
+        begin = str.find_first_not_of(tokens, end);
+    }
+    return ret;
+}
+
+std::string make_input(std::size_t const size, std::string_view const alphabet) {
+    std::string str{};
+    std::uint32_t seed = 12345;
+    for (std::size_t i = 0; i < size; ++i) {
+        seed = seed * 1664525u + 1013904223u;
+        str += alphabet[(seed >> 16) % alphabet.size()];
+    }
+    return str;
+}
+
+} // namespace
+
+TEST_CASE("strtok", "[string]") {
+    extra::strtok tok{"  hello, world\t"};
+    REQUIRE(tok(" ,\t") == "hello"sv);
+    REQUIRE(tok(" ,\t") == "world"sv);
+    REQUIRE(tok(" ,\t").empty());
+    REQUIRE(tok("a-b", "-") == "a"sv);
+    REQUIRE(tok("-") == "b"sv);
+
+    constexpr auto first = []{ extra::strtok t{"  constexpr tok"}; return t(" "); }();
+    static_assert(first == "constexpr"sv);
+}
+
+TEST_CASE("strtok_all", "[string]") {
+    REQUIRE(extra::strtok_all("hello world", " ") == std::vector{"hello"sv, "world"sv});
+    REQUIRE(extra::strtok_all("", " ").empty());
+    REQUIRE(extra::strtok_all("   ", " ").empty());
+
+    auto const alphabet = "ab ,\t\xe3\x80\x81\xff"sv;
+    auto const delims = " ,\xff"sv;
+    for (std::size_t const size : {1, 63, 64, 65, 127, 128, 1000}) {
+        auto const str = make_input(size, alphabet);
+        REQUIRE(extra::strtok_all(str, delims) == reference_strtok_all(str, delims));
+
+        extra::strtok tok{str};
+        std::vector<std::string_view> split{};
+        for (auto sv = tok(delims); !sv.empty(); sv = tok(delims))
+            split.push_back(sv);
+        REQUIRE(split == reference_strtok_all(str, delims));
+    }
+}
+
+TEST_CASE("delimiter_set", "[string]") {
+    extra::delimiter_set const set{" \t\x80\xff"};
+    for (int c = 0; c < 256; ++c) {
+        auto const ch = static_cast<char>(c);
+        REQUIRE(set.contains(ch) == (" \t\x80\xff"sv.find(ch) != std::string_view::npos));
+    }
+
+    auto const str = make_input(200, "xyz \t\x80"sv);
+    for (std::size_t pos = 0; pos <= str.size(); pos += 7) {
+        REQUIRE(set.find_first_of(str, pos) == std::string_view{str}.find_first_of(" \t\x80\xff"sv, pos));
+        REQUIRE(set.find_first_not_of(str, pos) == std::string_view{str}.find_first_not_of(" \t\x80\xff"sv, pos));
+    }
+}
+
+TEST_CASE("strtok_view", "[string]") {
+    extra::strtok_view const view{"  a bb  ccc ", " "};
+    std::vector<std::string_view> split{};
+    for (auto const sv : view)
+        split.push_back(sv);
+    REQUIRE(split == std::vector{"a"sv, "bb"sv, "ccc"sv});
+    REQUIRE(view.count() == 3);
+    REQUIRE(view.size_hint() >= view.count());
+    REQUIRE(!view.empty());
+    REQUIRE(extra::strtok_view{" \t ", " \t"}.empty());
+    REQUIRE(extra::strtok_view{"", " "}.count() == 0);
+
+    auto const str = make_input(1000, "ab ,\t"sv);
+    extra::strtok_view const large{str, " ,"};
+    std::vector<std::string_view> const expected = reference_strtok_all(str, " ,");
+    REQUIRE(std::vector<std::string_view>(large.begin(), std::next(large.begin(), 3)) ==
+        std::vector<std::string_view>(expected.begin(), expected.begin() + 3));
+    REQUIRE(large.count() == expected.size());
+
+    std::size_t i{};
+    std::vector<std::size_t> ids(expected.size());
+    for (auto [sv, id] : extra::zip(large, ids)) {
+        REQUIRE(sv == expected[i]);
+        id = i++;
+    }
+    REQUIRE(i == expected.size());
+}
+
+TEST_CASE("strtok_ct", "[string]") {
+    extra::strtok_ct<' ', ','> tok{" a, bb,c "};
+    REQUIRE(tok() == "a"sv);
+    REQUIRE(tok() == "bb"sv);
+    REQUIRE(tok() == "c"sv);
+    REQUIRE(tok().empty());
+
+    constexpr auto first = []{ extra::strtok_ct<'\n'> t{"\n\nline\n"}; return t(); }();
+    static_assert(first == "line"sv);
+    static_assert(extra::static_delimiter_set<' ', '\t'>::contains('\t'));
+
+    auto const str = make_input(1000, "ab ,\n"sv);
+    REQUIRE(extra::strtok_all<' ', ','>(str) == reference_strtok_all(str, " ,"));
+    REQUIRE(extra::strtok_all<'\n'>(str) == reference_strtok_all(str, "\n"));
+    REQUIRE(extra::basic_strtok_view{str, extra::static_delimiter_set<'\n'>{}}.count() == reference_strtok_all(str, "\n").size());
+}
+
+TEST_CASE("strtok_all parallel", "[string]") {
+    REQUIRE(extra::strtok_all(std::execution::par, "hello world", " ") == std::vector{"hello"sv, "world"sv});
+    REQUIRE(extra::strtok_all(std::execution::par, "", " ").empty());
+
+    // large enough to be split into several chunks
+    auto const str = make_input(3 * 1024 * 1024 + 17, "abcdefg ,"sv);
+    REQUIRE(extra::strtok_all(std::execution::par, str, " ,") == extra::strtok_all(str, " ,"));
+    REQUIRE(extra::strtok_all(std::execution::seq, str, "z") == std::vector{std::string_view{str}});
+}
+
+TEST_CASE("stream_tokenizer", "[string]") {
+    auto const str = make_input(5000, "abcd ,"sv);
+    for (std::size_t const step : {1, 3, 64, 100, 777, 5000}) {
+        extra::stream_tokenizer tok{" ,"};
+        std::vector<std::string> split{};
+        auto const push = [&](std::string_view const sv) { split.emplace_back(sv); };
+        for (std::size_t pos = 0; pos < str.size(); pos += step)
+            tok.feed(std::string_view{str}.substr(pos, step), push);
+        tok.finish(push);
+
+        auto const expected = reference_strtok_all(str, " ,");
+        REQUIRE(std::equal(split.begin(), split.end(), expected.begin(), expected.end()));
+    }
+
+    extra::stream_tokenizer tok{" "};
+    std::vector<std::string_view> views{};
+    auto const push = [&](std::string_view const sv) { views.push_back(sv); };
+    std::string_view const first = "ab cd e";
+    tok.feed(first, push);
+    REQUIRE(views == std::vector{"ab"sv, "cd"sv});
+    REQUIRE(views[0].data() == first.data());
+    REQUIRE(tok.pending() == "e"sv);
+    tok.feed("f g", [&](std::string_view const sv) { REQUIRE(sv == "ef"sv); });
+    tok.finish([&](std::string_view const sv) { REQUIRE(sv == "g"sv); });
+    REQUIRE(tok.pending().empty());
+}
+
+TEST_CASE("split_on", "[string]") {
+    auto const pieces = [](extra::split_view const& view) {
+        std::vector<std::string_view> ret{};
+        for (auto const sv : view)
+            ret.push_back(sv);
+        return ret;
+    };
+    REQUIRE(pieces(extra::split_on("GET / HTTP/1.1\r\nHost: a\r\n\r\n", "\r\n")) == std::vector{"GET / HTTP/1.1"sv, "Host: a"sv});
+    REQUIRE(pieces(extra::split_on("a::b:c::::d", "::")) == std::vector{"a"sv, "b:c"sv, "d"sv});
+    REQUIRE(pieces(extra::split_on("||", "||")).empty());
+    REQUIRE(pieces(extra::split_on("abc", "")) == std::vector{"abc"sv});
+
+    auto const str = make_input(3000, "ab|"sv);
+    for (std::string_view const delim : {"|"sv, "||"sv, "a|b"sv, "ab|ab|ab|ab|ab|ab|ab"sv}) {
+        std::vector<std::string_view> expected{};
+        std::string_view const sv{str};
+        for (std::size_t pos = 0; pos < sv.size();) {
+            auto const found = std::min(sv.find(delim, pos), sv.size());
+            if (found != pos)
+                expected.push_back(sv.substr(pos, found - pos));
+            pos = found == sv.size() ? found : found + delim.size();
+        }
+        REQUIRE(pieces(extra::split_on(str, delim)) == expected);
+    }
+
+    std::string const long_delim(300, 'x');
+    auto const haystack = "a" + long_delim + "b" + long_delim;
+    REQUIRE(pieces(extra::split_on(haystack, long_delim)) == std::vector{"a"sv, "b"sv});
+
+    // an iterator outlives the temporary view it came from
+    auto it = extra::split_on("a::b::c", "::").begin();
+    REQUIRE(*it == "a");
+    ++it;
+    REQUIRE(*it == "b");
+    REQUIRE(*++it == "c");
+    REQUIRE(++it == extra::split_view::sentinel{});
+}
+
+TEST_CASE("csv_fields", "[string]") {
+    std::vector<std::string_view> values{};
+    std::vector<bool> ends{};
+    for (auto const& field : extra::csv_fields("id,name,note\r\n1,\"Smith, J\",\"said \"\"hi\"\"\"\n2,,\n"))  {
+        values.push_back(field.value());
+        ends.push_back(field.end_of_record);
+    }
+    REQUIRE(values == std::vector{"id"sv, "name"sv, "note"sv, "1"sv, "Smith, J"sv, "said \"\"hi\"\""sv, "2"sv, ""sv, ""sv});
+    REQUIRE(ends == std::vector<bool>{false, false, true, false, false, true, false, false, true});
+
+    auto const quoted = *std::next(extra::csv_fields("1,\"said \"\"hi\"\"\"").begin());
+    REQUIRE(quoted.quoted());
+    REQUIRE(quoted.unescaped() == "said \"hi\"");
+
+    REQUIRE(std::distance(extra::csv_fields("").begin(), extra::csv_view::iterator{}) == 0);
+    REQUIRE(std::next(extra::csv_fields("a\tb", '\t').begin())->raw == "b"sv);
+
+    // a quoted field spanning several 64 byte blocks
+    std::string const text = "x,\"" + std::string(150, ',') + "\",y";
+    std::vector<std::size_t> sizes{};
+    for (auto const& field : extra::csv_fields(text))
+        sizes.push_back(field.value().size());
+    REQUIRE(sizes == std::vector<std::size_t>{1, 150, 1});
+
+    // compare against a per character state machine
+    auto const str = make_input(2000, "ab,\"\n"sv);
+    std::vector<std::string_view> expected{};
+    std::size_t start{};
+    bool in_quote{};
+    for (std::size_t i = 0; i < str.size(); ++i) {
+        if (str[i] == '"')
+            in_quote = !in_quote;
+        else if (!in_quote && (str[i] == ',' || str[i] == '\n')) {
+            expected.emplace_back(str.data() + start, i - start);
+            start = i + 1;
+        }
+    }
+    if (start < str.size() || str.back() == ',')
+        expected.emplace_back(str.data() + start, str.size() - start);
+    std::vector<std::string_view> raw{};
+    for (auto const& field : extra::csv_fields(str))
+        raw.push_back(field.raw);
+    REQUIRE(raw == expected);
+}
+
+TEST_CASE("strtok_count", "[string]") {
+    static_assert(extra::strtok_count("a bb  ccc ", " ") == 3);
+    static_assert(extra::strtok_count<','>(",a,,b") == 2);
+    REQUIRE(extra::strtok_count("", " ") == 0);
+    REQUIRE(extra::strtok_count("    ", " ") == 0);
+
+    auto const str = make_input(10000, "ab \t\xff"sv);
+    REQUIRE(extra::strtok_count(str, " \t\xff") == reference_strtok_all(str, " \t\xff").size());
+    REQUIRE(extra::strtok_count(str, extra::delimiter_set{" "}) == reference_strtok_all(str, " ").size());
+}
+
+TEST_CASE("parse_tokens", "[string]") {
+    std::vector<int> ints{};
+    std::vector<std::pair<std::size_t, std::errc>> errors{};
+    extra::parse_tokens<int>(" 1,-22, x ,12345678,99999999999, 7z", " ,", std::back_inserter(ints),
+        [&](std::size_t const index, std::string_view, std::errc const ec) { errors.emplace_back(index, ec); });
+    REQUIRE(ints == std::vector{1, -22, 12345678});
+    REQUIRE(errors == std::vector<std::pair<std::size_t, std::errc>>{
+        {2, std::errc::invalid_argument}, {4, std::errc::result_out_of_range}, {5, std::errc::invalid_argument}});
+
+    double doubles[3]{};
+    auto const last = extra::parse_tokens<double>("1.5 -2e3 0.25", " ", std::begin(doubles));
+    REQUIRE(last == std::end(doubles));
+    REQUIRE(doubles[1] == -2000.0);
+
+    std::vector<std::int64_t> wide{};
+    extra::parse_tokens<std::int64_t>("1234567890123456 -9223372036854775808 9223372036854775808", " ", std::back_inserter(wide));
+    REQUIRE(wide == std::vector<std::int64_t>{1234567890123456, std::numeric_limits<std::int64_t>::min()});
+
+    std::vector<std::uint64_t> unsigned_wide{};
+    extra::parse_tokens<std::uint64_t>("18446744073709551615 -1 00000000000000000042", " ", std::back_inserter(unsigned_wide));
+    REQUIRE(unsigned_wide == std::vector<std::uint64_t>{std::numeric_limits<std::uint64_t>::max(), 42});
+
+    // compare against from_chars over numbers of every length
+    std::string str{};
+    std::vector<std::int64_t> expected{};
+    std::uint64_t n = 7;
+    for (int i = 0; i < 200; ++i) {
+        n = n * 3 + static_cast<std::uint64_t>(i);
+        auto const v = (i % 2 ? -1 : 1) * static_cast<std::int64_t>(n % 1000000000000000000);
+        str += std::to_string(v) + ' ';
+        expected.push_back(v);
+    }
+    std::vector<std::int64_t> parsed{};
+    extra::parse_tokens<std::int64_t>(str, " ", std::back_inserter(parsed));
+    REQUIRE(parsed == expected);
+}
+
+TEST_CASE("rstrtok", "[string]") {
+    extra::rstrtok tok{"GET /index.html 200 13ms  "};
+    REQUIRE(tok(" ") == "13ms"sv);
+    REQUIRE(tok(" ") == "200"sv);
+    REQUIRE(tok(" ") == "/index.html"sv);
+    REQUIRE(tok(" ") == "GET"sv);
+    REQUIRE(tok(" ").empty());
+    REQUIRE(tok("a b", " ") == "b"sv);
+
+    constexpr auto last = []{ extra::rstrtok t{"constexpr tok "}; return t(" "); }();
+    static_assert(last == "tok"sv);
+
+    auto const str = make_input(1000, "ab ,\xff"sv);
+    auto expected = reference_strtok_all(str, " ,\xff");
+    std::reverse(expected.begin(), expected.end());
+    extra::rstrtok rtok{str};
+    std::vector<std::string_view> split{};
+    for (auto sv = rtok(" ,\xff"); !sv.empty(); sv = rtok(" ,\xff"))
+        split.push_back(sv);
+    REQUIRE(split == expected);
+
+    extra::delimiter_set const set{" ,"};
+    for (std::size_t pos = 0; pos < str.size() + 5; pos += 13) {
+        REQUIRE(set.find_last_of(str, pos) == std::string_view{str}.find_last_of(" ,", pos));
+        REQUIRE(set.find_last_not_of(str, pos) == std::string_view{str}.find_last_not_of(" ,", pos));
+    }
+}
+
+TEST_CASE("intern_pool", "[string]") {
+    extra::intern_pool pool{16};
+    auto const get = pool.intern("GET");
+    auto const post = pool.intern("POST");
+    REQUIRE(get != post);
+    REQUIRE(pool.intern(std::string{"GET"}) == get);
+    REQUIRE(pool.view(post) == "POST"sv);
+    REQUIRE(pool.find("PUT") == std::nullopt);
+    REQUIRE(pool.find("GET") == get);
+
+    // views stay valid while the pool grows, including strings larger than a block
+    auto const first = pool.intern_view("a string larger than one block");
+    auto const str = make_input(5000, "abcd "sv);
+    auto const tokens = extra::strtok_all(str, " ");
+    std::vector<extra::intern_pool::id_type> ids{};
+    for (auto const sv : tokens)
+        ids.push_back(pool.intern(sv));
+    REQUIRE(first == "a string larger than one block"sv);
+    for (std::size_t i = 0; i < tokens.size(); ++i)
+        REQUIRE(pool.view(ids[i]) == tokens[i]);
+
+    auto const& stats = pool.stats();
+    REQUIRE(stats.lookups == 4 + tokens.size());
+    REQUIRE(stats.lookups - stats.hits == pool.size());
+    REQUIRE(stats.hit_rate() > 0.0);
+    REQUIRE(stats.bytes_saved > 0);
+
+    extra::concurrent_intern_pool shared{4};
+    std::vector<std::thread> threads{};
+    std::vector<std::vector<extra::intern_pool::id_type>> thread_ids(4);
+    for (std::size_t t = 0; t < 4; ++t)
+        threads.emplace_back([&, t] {
+            for (auto const sv : tokens)
+                thread_ids[t].push_back(shared.intern(sv));
+        });
+    for (auto& thread : threads)
+        thread.join();
+    for (std::size_t t = 1; t < 4; ++t)
+        REQUIRE(thread_ids[t] == thread_ids[0]);
+    for (std::size_t i = 0; i < tokens.size(); ++i)
+        REQUIRE(shared.view(thread_ids[0][i]) == tokens[i]);
+    REQUIRE(shared.stats().lookups == 4 * tokens.size());
+    REQUIRE(shared.stats().lookups - shared.stats().hits == pool.size() - 3);
+}
+
+TEST_CASE("multi_matcher", "[string]") {
+    auto const naive = [](std::vector<std::string> const& patterns, std::string_view const text) {
+        std::vector<std::tuple<std::size_t, std::size_t, std::size_t>> ret{};
+        for (std::size_t i = 0; i < patterns.size(); ++i)
+            for (auto pos = patterns[i].empty() ? std::string_view::npos : text.find(patterns[i]);
+                 pos != std::string_view::npos; pos = text.find(patterns[i], pos + 1))
+                ret.emplace_back(pos + patterns[i].size(), i, pos);
+        std::sort(ret.begin(), ret.end());
+        return ret;
+    };
+    auto const matches = [](extra::multi_matcher const& m, std::string_view const text) {
+        std::vector<std::tuple<std::size_t, std::size_t, std::size_t>> ret{};
+        m.for_each_match(text, [&](extra::multi_match const& match) {
+            ret.emplace_back(match.offset + match.length, match.pattern, match.offset);
+        });
+        std::sort(ret.begin(), ret.end());
+        return ret;
+    };
+
+    extra::multi_matcher const m{"he", "she", "his", "hers", "", "he"};
+    REQUIRE(m.size() == 6);
+    REQUIRE(m.pattern(3) == "hers"sv);
+    // h, e, s, i, r and one class for every other byte
+    REQUIRE(m.class_count() == 6);
+    auto const all = m.find_all("ushers");
+    REQUIRE(all.size() == 4);
+    REQUIRE(all[0].pattern == 1);
+    REQUIRE(all[0].offset == 1);
+    REQUIRE(matches(m, "ushers") == naive({"he", "she", "his", "hers", "", "he"}, "ushers"));
+
+    auto const first = m.find_first("this shell");
+    REQUIRE(first.has_value());
+    REQUIRE(first->pattern == 2);
+    REQUIRE(first->offset == 1);
+    REQUIRE(m.contains_any("a shoe"sv) == false);
+    REQUIRE(extra::multi_matcher{}.find_all("abc").empty());
+
+    // many start bytes take the dfa path, few take the prefiltered one
+    auto const text = make_input(5000, "abcdefg \xff"sv);
+    for (auto const alphabet : {"abcdefg\xff"sv, "ab"sv}) {
+        std::vector<std::string> patterns{};
+        for (std::size_t i = 0; i < 40; ++i) {
+            auto const pattern = make_input(40 + i, alphabet);
+            patterns.push_back(pattern.substr(i, 1 + i % 5));
+        }
+        extra::multi_matcher const matcher{patterns};
+        REQUIRE(matches(matcher, text) == naive(patterns, text));
+    }
+
+    // over the tokens of a strtok_view, offsets are relative to the token
+    std::size_t count{};
+    m.for_each_match(extra::strtok_view{"she sells his shells", " "}, [&](std::string_view const token, extra::multi_match const& match) {
+        REQUIRE(token.substr(match.offset, match.length) == m.pattern(match.pattern));
+        ++count;
+    });
+    REQUIRE(count == matches(m, "she sells his shells").size());
+}
+
+TEST_CASE("kv_range", "[string]") {
+    std::vector<std::pair<std::string_view, std::string_view>> pairs{};
+    for (auto const& [key, value] : extra::kv_range("a=1&&b=x=y&flag&=v&c="))
+        pairs.emplace_back(key, value);
+    REQUIRE(pairs == std::vector<std::pair<std::string_view, std::string_view>>{
+        {"a", "1"}, {"b", "x=y"}, {"flag", ""}, {"", "v"}, {"c", ""}});
+
+    auto const config = extra::kv_range("x:1; y:2", "; ", ':');
+    std::size_t count{};
+    for (auto it = config.begin(); it != config.end(); ++it)
+        ++count;
+    REQUIRE(count == 2);
+    REQUIRE(config.find("y") == "2"sv);
+    REQUIRE(config.find("z") == std::nullopt);
+
+    constexpr auto found = extra::kv_range("user=bob&id=7").find("id");
+    static_assert(found == "7"sv);
+
+    std::string decoded{};
+    extra::percent_decode("a%20b%2Fc+%zz%4", std::back_inserter(decoded));
+    REQUIRE(decoded == "a b/c+%zz%4");
+
+    std::string buffer{};
+    extra::kv_pair const plain{"name", "bob"};
+    REQUIRE(plain.decoded(buffer).key.data() == plain.key.data());
+    auto const pair = extra::kv_pair{"first+name", "J%C3%BCrgen%26co"}.decoded(buffer);
+    REQUIRE(pair.key == "first name"sv);
+    REQUIRE(pair.value == "J\xc3\xbcrgen&co"sv);
+
+    // pairs spanning the 64 byte blocks of the classifier
+    auto const str = make_input(3000, "abc=&"sv);
+    std::vector<std::pair<std::string_view, std::string_view>> expected{};
+    for (auto const piece : reference_strtok_all(str, "&")) {
+        auto const eq = piece.find('=');
+        expected.emplace_back(piece.substr(0, eq), eq == std::string_view::npos ? ""sv : piece.substr(eq + 1));
+    }
+    pairs.clear();
+    for (auto const& pair : extra::kv_range(str))
+        pairs.emplace_back(pair.key, pair.value);
+    REQUIRE(pairs == expected);
+}
+
+TEST_CASE("small_string", "[string]") {
+    static_assert(sizeof(extra::small_string<23>) == 32);
+    static_assert(sizeof(extra::small_string<15>) == 24);
+    static_assert(std::is_nothrow_move_constructible_v<extra::small_string<23>>);
+    static_assert(extra::is_trivially_relocatable_v<extra::small_string<23>>);
+
+    extra::small_string<7> str{"token"};
+    REQUIRE(str == "token");
+    REQUIRE(!str.on_heap());
+    REQUIRE(str.capacity() == 7);
+    str += "izer";
+    REQUIRE(str.on_heap());
+    REQUIRE(str == "tokenizer"sv);
+    REQUIRE(std::strlen(str.c_str()) == 9);
+
+    // appending a piece of itself across the spill
+    extra::small_string<7> self{"abcdef"};
+    self.append(self.view().substr(1));
+    REQUIRE(self == "abcdefbcdef");
+    self.assign(self.view().substr(6));
+    REQUIRE(self == "bcdef");
+    self.shrink_to_fit();
+    REQUIRE(!self.on_heap());
+    REQUIRE(self == "bcdef");
+
+    auto moved = std::move(str);
+    REQUIRE(moved == "tokenizer");
+    REQUIRE(str.empty());
+    str = moved;
+    REQUIRE(str == moved);
+    str.clear();
+    REQUIRE(str.empty());
+    REQUIRE(str.capacity() >= 9);
+    str.resize(3, 'x');
+    str.push_back('y');
+    REQUIRE(str == "xxxy");
+
+    extra::small_string<15> const a{"a"}, b{"b"};
+    REQUIRE(a < b);
+    REQUIRE(a != b);
+    REQUIRE(std::hash<extra::small_string<15>>{}(a) == std::hash<std::string_view>{}("a"));
+
+    // vectors of tokens that outlive the source buffer
+    std::vector<extra::small_string<23>> tokens{};
+    {
+        auto const input = make_input(3000, "abcdefghijk "sv);
+        for (auto const sv : extra::strtok_view{input, " "})
+            tokens.emplace_back(sv);
+        auto const expected = extra::strtok_all(input, " ");
+        REQUIRE(tokens.size() == expected.size());
+        for (std::size_t i = 0; i < tokens.size(); ++i)
+            REQUIRE(tokens[i] == expected[i]);
+    }
+
+#if defined(__cpp_constexpr_dynamic_alloc)
+    constexpr auto spilled = [] {
+        extra::small_string<3> s{"ab"};
+        s += "cdef";
+        s.assign("x");
+        s.shrink_to_fit();
+        return s.size() + s.on_heap();
+    }();
+    static_assert(spilled == 1);
+#endif // __cpp_constexpr_dynamic_alloc
+}
+
+TEST_CASE("string_arena", "[string]") {
+    // blocks grow from small to the cap, every stored string stays intact
+    extra::detail::string_arena arena{4096};
+    for (int round = 0; round < 2; ++round) {
+        std::vector<std::string> expected{};
+        std::vector<std::string_view> stored{};
+        for (std::size_t i = 0; i < 2000; ++i) {
+            expected.emplace_back(i * 37 % 1500 + (i % 97 == 0 ? 5000 : 0), static_cast<char>('a' + i % 26));
+            stored.push_back(arena.store(expected.back()));
+        }
+        REQUIRE(std::equal(stored.begin(), stored.end(), expected.begin(), expected.end()));
+        REQUIRE(arena.store("").empty());
+        arena.reset();
+    }
+}
+
+TEST_CASE("string_builder", "[string]") {
+    extra::string_builder builder{16};
+    std::string_view const line{"GET /index.html 200"};
+    extra::strtok tok{line};
+    auto const method = tok(" ");
+    auto const path = tok(" ");
+    builder.append(path).append(' ').append(method).append(' ').append(-42);
+    REQUIRE(builder.size() == 19);
+    REQUIRE(builder.str() == "/index.html GET -42");
+
+    // adjacent views extend the previous piece
+    builder.reset();
+    REQUIRE(builder.empty());
+    builder.append(line.substr(0, 3)).append(line.substr(3, 5)).append_copy(std::string{"abc"}).append('d');
+    REQUIRE(builder.pieces().size() == 2);
+    std::string out(builder.size(), '\0');
+    REQUIRE(builder.copy_to(out.data(), out.size()) == out.data() + out.size());
+    REQUIRE(out == "GET /indabcd");
+    REQUIRE_THROWS_AS(builder.copy_to(out.data(), out.size() - 1), std::length_error);
+
+    // copies larger than an arena block, and reuse after reset
+    std::string const big(100, 'x');
+    for (int round = 0; round < 3; ++round) {
+        builder.reset();
+        builder.append_copy(big).append_copy("yz").append(std::numeric_limits<std::uint64_t>::max());
+        REQUIRE(builder.str() == big + "yz18446744073709551615");
+    }
+
+    // temporaries are copied, lvalue strings and literals are referenced
+    builder.reset();
+    std::string const kept{"kept"};
+    builder.append(std::string(20, 't')).append(kept).append("!");
+    REQUIRE(builder.pieces()[1].data() == kept.data());
+    REQUIRE(builder.str() == std::string(20, 't') + "kept!");
+}
+
+TEST_CASE("utf8_strtok", "[string]") {
+    // a byte oriented set would split U+3042 (e3 81 82) on the bytes of U+3001 (e3 80 81)
+    REQUIRE(extra::utf8_strtok_all("あ、い b  c", " 、 ") ==
+        std::vector<std::string_view>{"あ", "い", "b", "c"});
+    REQUIRE(extra::utf8_strtok_all("", " ").empty());
+    REQUIRE_THROWS_AS(extra::utf8_delimiter_set{"\xff"}, std::invalid_argument);
+    REQUIRE_THROWS_AS(extra::utf8_strtok_all("ok \xe3\x80 ", " "), std::system_error);
+
+    extra::utf8_delimiter_set const delims{" ,、"};
+    REQUIRE(delims.find_first_of("あ、") == 3);
+    REQUIRE(delims.match("、", 0) == 3);
+    REQUIRE(delims.match("。", 0) == 0);
+
+    // ascii text takes the byte class path and splits like strtok_all
+    auto const ascii = make_input(5000, "abc ,"sv);
+    REQUIRE(extra::utf8_strtok_all(ascii, delims) == extra::strtok_all(ascii, " ,"));
+
+    std::string text{};
+    for (std::size_t i = 0; i < 3000; ++i)
+        text += i % 7 == 0 ? "、" : i % 5 == 0 ? " " : i % 3 == 0 ? "\U0001f600" : "éx";
+    std::vector<std::string_view> tokens{};
+    for (auto const token : extra::utf8_strtok_view{text, delims})
+        tokens.push_back(token);
+    REQUIRE(tokens == extra::utf8_strtok_all(text, delims));
+    REQUIRE(tokens.size() > 100);
+
+    // the view keeps its own copy of a temporary delimiter set
+    std::vector<std::string_view> words{};
+    for (auto const token : extra::utf8_strtok_view{"a b,c", extra::utf8_delimiter_set{" ,"}})
+        words.push_back(token);
+    REQUIRE(words == std::vector{"a"sv, "b"sv, "c"sv});
+
+    // an error past the first validation chunk is found while iterating
+    text += "\xc0\x80";
+    extra::utf8_strtok_view const view{text, delims};
+    auto it = view.begin();
+    REQUIRE(*it == tokens.front());
+    REQUIRE_THROWS_AS([&] { while (it != view.end()) ++it; }(), std::system_error);
+}
+
+TEST_CASE("is_valid_utf8", "[string]") {
+    for (auto const valid : {""sv, "abc"sv, "éあ\U0001f600"sv, "\xf4\x8f\xbf\xbf"sv, "\xed\x9f\xbf"sv})
+        REQUIRE(extra::is_valid_utf8(valid));
+    for (auto const invalid : {"\x80"sv, "\xc0\xaf"sv, "\xe0\x80\xaf"sv, "\xed\xa0\x80"sv, "\xf4\x90\x80\x80"sv,
+                               "\xf8\x88\x80\x80\x80"sv, "\xe3\x81"sv, "a\xe3\x81" "b"sv, "\xc3\xa9\xa9"sv})
+        REQUIRE(!extra::is_valid_utf8(invalid));
+
+    // every length and alignment against the scalar reference
+    auto const alphabet = "ab\x80\xbf\xc2\xdf\xe0\xed\xef\xf0\xf4\xf5"sv;
+    for (std::size_t size = 1; size < 200; ++size) {
+        auto str = make_input(size * 37, alphabet).substr(size, size);
+        REQUIRE(extra::is_valid_utf8(str) == extra::detail::utf8_valid_scalar(str.data(), str.size()));
+        // a valid prefix followed by one broken sequence at every position
+        std::string const prefix(size, 'a');
+        for (auto const bad : {"\xe3\x81"sv, "\x80"sv, "\xc0\x80"sv})
+            REQUIRE(!extra::is_valid_utf8(prefix + std::string{bad}));
+        REQUIRE(extra::is_valid_utf8(prefix + "\U0001f600"));
+    }
+}
+
+TEST_CASE("iequals", "[string]") {
+    REQUIRE(extra::iequals("Content-Length", "content-length"));
+    REQUIRE(!extra::iequals("Content-Length", "content-lengt"));
+    REQUIRE(!extra::iequals("[", "{"));
+    REQUIRE(!extra::iequals("\xc9", "\xe9"));
+    REQUIRE(extra::istarts_with("Transfer-Encoding: chunked", "TRANSFER-encoding"));
+    REQUIRE(extra::iends_with("text/HTML", "/html"));
+    REQUIRE(!extra::istarts_with("ab", "abc"));
+    static_assert(extra::iequals("Host", "hOST"));
+    static_assert(extra::ifind("GET /Index.HTML", "index.html") == 5);
+
+    auto const lower = [](std::string str) {
+        for (auto& c : str)
+            c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        return str;
+    };
+
+    // every length across the swar and vector widths, with one byte changed
+    auto const str = make_input(300, "aBcZz@[`{ \x80\xc1"sv);
+    for (std::size_t size = 0; size < 100; ++size) {
+        auto a = str.substr(size, size);
+        auto b = lower(a);
+        REQUIRE(extra::iequals(a, b));
+        REQUIRE(extra::ihash_bytes(a) == extra::ihash_bytes(b));
+        REQUIRE(extra::ihash{}(a) == extra::ihash{}(b));
+        if (size != 0) {
+            b[size / 3] = '#';
+            REQUIRE(extra::iequals(a, b) == (a[size / 3] == '#'));
+        }
+    }
+
+    auto const haystack = make_input(3000, "abcABC xyz"sv);
+    auto const folded = lower(haystack);
+    for (auto const needle : {"a"sv, "Bc"sv, "cAx"sv, "ABCabcABCabc"sv, "xyZ AbC"sv, "q"sv})
+        for (std::size_t pos = 0; pos < haystack.size(); pos += 97)
+            REQUIRE(extra::ifind(haystack, needle, pos) == std::string_view{folded}.find(lower(std::string{needle}), pos));
+    REQUIRE(extra::ifind("abc", "", 3) == 3);
+    REQUIRE(extra::ifind("abc", "", 4) == std::string_view::npos);
+
+    std::unordered_map<std::string, int, extra::ihash, extra::iequal_to> headers{{"Content-Type", 1}};
+    REQUIRE(headers.count("content-type") == 1);
+}
+
+TEST_CASE("lines", "[string]") {
+    std::vector<std::tuple<std::string_view, std::size_t, std::size_t>> all{};
+    for (auto const& [text, number, offset] : extra::lines("a\r\n\nb\r\n"))
+        all.emplace_back(text, number, offset);
+    REQUIRE(all == decltype(all){{"a", 1, 0}, {"", 2, 3}, {"b", 3, 4}});
+    static_assert(std::is_same_v<decltype(*extra::lines("").begin()), extra::text_line const&>);
+
+    std::vector<std::string_view> texts{};
+    for (auto const& line : extra::lines("\n\na\r\n\r\nb", extra::line_options::keep_cr | extra::line_options::skip_empty))
+        texts.push_back(line.text);
+    REQUIRE(texts == std::vector<std::string_view>{"a\r", "\r", "b"});
+
+    REQUIRE(extra::lines("").begin() == extra::lines("").end());
+    REQUIRE(extra::lines("\n").begin()->text.empty());
+    constexpr auto third = [] {
+        auto it = extra::lines("x\ny\nz").begin();
+        ++it;
+        ++it;
+        return it->number * 10 + it->offset;
+    }();
+    static_assert(third == 34);
+
+    // lines spanning the 64 byte blocks, against a split on every newline
+    auto const str = make_input(5000, "ab\n\r\n\n     "sv);
+    std::vector<std::string_view> expected{};
+    for (std::size_t begin = 0; begin < str.size();) {
+        auto end = str.find('\n', begin);
+        end = end == std::string::npos ? str.size() : end;
+        auto text = std::string_view{str}.substr(begin, end - begin);
+        if (!text.empty() && text.back() == '\r')
+            text.remove_suffix(1);
+        expected.push_back(text);
+        begin = end + 1;
+    }
+    texts.clear();
+    std::size_t number{};
+    for (auto const& line : extra::lines(str)) {
+        REQUIRE(line.number == ++number);
+        REQUIRE(line.text.data() == str.data() + line.offset);
+        texts.push_back(line.text);
+    }
+    REQUIRE(texts == expected);
+}
@@ -0,0 +1,110 @@
+// unordered_map.cpp
+
+#include "catch.hpp"
+#include "../include/unordered_map.hpp"
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace std::string_view_literals;
+
+namespace {
+
+// access log like tokens, mostly repeats of a few hundred distinct values
+std::string make_log(std::size_t const lines) {
+    std::string log{};
+    std::uint32_t seed = 42;
+    for (std::size_t i = 0; i < lines; ++i) {
+        seed = seed * 1664525u + 1013904223u;
+        log += "host" + std::to_string((seed >> 8) % 200) + " GET /path/" + std::to_string((seed >> 16) % 500) + " 200\n";
+    }
+    return log;
+}
+
+} // namespace
+
+TEST_CASE("string_map", "[unordered_map]") {
+    extra::string_map<int> map{};
+    REQUIRE(map.empty());
+    REQUIRE(map.find("missing") == map.end());
+
+    map["GET"] = 1;
+    REQUIRE(map.try_emplace("POST", 2).second);
+    REQUIRE(!map.try_emplace(std::string{"POST"}, 3).second);
+    REQUIRE(map.at("POST") == 2);
+    REQUIRE(map.contains("GET"));
+    REQUIRE_THROWS_AS(map.at("PUT"), std::out_of_range);
+
+    auto const log = make_log(2000);
+    std::unordered_map<std::string, int> expected{};
+    for (auto const token : extra::strtok_view{log, " \n"}) {
+        ++map[token];
+        ++expected[std::string{token}];
+    }
+    expected["GET"] += 1;
+    expected["POST"] = 2;
+    REQUIRE(map.size() == expected.size());
+    for (auto const& [key, value] : map)
+        REQUIRE(expected.at(std::string{key}) == value);
+
+    // erase every other key, the rest must stay reachable
+    std::size_t i{};
+    for (auto const& [key, value] : expected)
+        if (i++ % 2 == 0)
+            REQUIRE(map.erase(key) == 1);
+    REQUIRE(map.erase("not a key") == 0);
+    i = 0;
+    for (auto const& [key, value] : expected) {
+        if (i++ % 2 == 0)
+            REQUIRE(!map.contains(key));
+        else
+            REQUIRE(map.at(key) == value);
+    }
+    REQUIRE(map.size() == expected.size() / 2);
+
+    auto copy = map;
+    map.clear();
+    REQUIRE(map.empty());
+    REQUIRE(map.begin() == map.end());
+    REQUIRE(copy.size() == expected.size() / 2);
+
+    extra::string_map<std::string> owners{};
+    for (int n = 0; n < 1000; ++n)
+        owners.try_emplace(std::to_string(n), std::string(20, 'x'));
+    auto moved = std::move(owners);
+    REQUIRE(moved.size() == 1000);
+    REQUIRE(moved.at("999").size() == 20);
+    owners["reused"] = "after move";
+    REQUIRE(owners.size() == 1);
+
+    // relocated by memcpy on rehash, heap and inline values alike
+    extra::string_map<extra::small_string<7>> small{};
+    for (int n = 0; n < 1000; ++n)
+        small.try_emplace(std::to_string(n), std::string(static_cast<std::size_t>(n % 16), 'y'));
+    REQUIRE(small.size() == 1000);
+    for (int n = 0; n < 1000; ++n)
+        REQUIRE(small.at(std::to_string(n)) == std::string(static_cast<std::size_t>(n % 16), 'y'));
+}
+
+TEST_CASE("string_map benchmark", "[.][benchmark][unordered_map]") {
+    auto const log = make_log(200000);
+    auto const tokens = extra::strtok_all(log, " \n");
+    std::size_t std_size{}, extra_size{};
+
+    BENCHMARK("std::unordered_map<std::string, int>") {
+        std::unordered_map<std::string, int> map{};
+        for (auto const token : tokens)
+            ++map[std::string{token}];
+        std_size = map.size();
+    }
+
+    BENCHMARK("extra::string_map<int>") {
+        extra::string_map<int> map{};
+        for (auto const token : tokens)
+            ++map[token];
+        extra_size = map.size();
+    }
+
+    REQUIRE(std_size == extra_size);
+}